@@ -0,0 +1,1103 @@
+//Cache model: allocation, address decode, replacement, and the read/write
+//simulation paths. Moved out of cachesim.c so the sweep engine and main()
+//can share one implementation.
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "cache.h"
+#include "prefetch.h"
+#include "probe.h"
+#include "misspath.h"
+
+//Defined with the specialized kernels below; used by create_cache() for dispatch
+static CacheBatchKernel select_batch_kernel(int set_lines, int policy);
+
+//Arenas at least this large are mmap'd with huge-page backing where available
+#define ARENA_MMAP_MIN (1UL << 21)
+
+//Rounds an arena segment up to cache-line alignment
+static size_t arena_align(size_t bytes) {
+    return (bytes + 63) & ~(size_t)63;
+}
+
+//Allocates the metadata arena. Large arenas are mapped anonymously, first via
+//MAP_HUGETLB and then with MADV_HUGEPAGE as the graceful fallback, so LLC-sized
+//models stop thrashing the simulator's own TLB. Anonymous mappings are
+//zero-filled and faulted on first write, which gives first-touch NUMA placement:
+//under the threaded sweep each configuration's pages land on the node of the
+//worker that simulates it, not the loader thread's. Small arenas (and any mmap
+//failure) fall back to a zeroed malloc, signaled by *bytes == 0.
+static void* arena_map(size_t *bytes) {
+    size_t len = *bytes;
+    if (len >= ARENA_MMAP_MIN) {
+#ifdef MAP_HUGETLB
+        size_t huge_len = (len + ARENA_MMAP_MIN - 1) & ~(ARENA_MMAP_MIN - 1);
+        void *p = mmap(NULL, huge_len, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            *bytes = huge_len;
+            return p;
+        }
+#endif
+        void *p2 = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p2 != MAP_FAILED) {
+#ifdef MADV_HUGEPAGE
+            madvise(p2, len, MADV_HUGEPAGE);
+#endif
+            return p2;
+        }
+    }
+    void *p = malloc(len);
+    if (p) {
+        memset(p, 0, len);
+    }
+    *bytes = 0;
+    return p;
+}
+
+//Returns 1 if x is a power of two, else 0 (used to validate CLI args)
+int is_power_of_two(unsigned long x) {
+    return x != 0 && (x & (x - 1)) == 0;
+}
+
+//Integer log2 for powers of two (counts how many bits needed to represent x)
+int log2_int(unsigned long x) {
+    int count = 0;
+    while (x > 1) {
+        x >>= 1;
+        count++;
+    }
+    return count;
+}
+
+//Parses a policy string; returns the policy id or -1 if invalid
+int parse_policy(const char *policy_str) {
+    if (strcmp(policy_str, "fifo") == 0) return POLICY_FIFO;
+    if (strcmp(policy_str, "lru") == 0) return POLICY_LRU;
+    if (strcmp(policy_str, "plru") == 0) return POLICY_PLRU;
+    if (strcmp(policy_str, "srrip") == 0) return POLICY_SRRIP;
+    if (strcmp(policy_str, "random") == 0) return POLICY_RANDOM;
+    return -1;
+}
+
+//Parses an index-hash string; returns the hash id or -1 if invalid
+int parse_index_hash(const char *hash_str) {
+    if (strcmp(hash_str, "mask") == 0) return HASH_MASK;
+    if (strcmp(hash_str, "xor") == 0) return HASH_XOR;
+    if (strcmp(hash_str, "skew") == 0) return HASH_SKEW;
+    return -1;
+}
+
+//Parses an associativity spec: direct | assoc | assoc:n
+int parse_associativity(const char *assoc_str, int cache_size, int block_size) {
+    if (strcmp(assoc_str, "direct") == 0) {
+        return 1;
+    }
+    if (strcmp(assoc_str, "assoc") == 0) {
+        //one set, all lines in that set
+        return cache_size / block_size;
+    }
+    if (strncmp(assoc_str, "assoc:", 6) == 0) {
+        int associativity = atoi(assoc_str + 6);
+        if (!is_power_of_two(associativity)) {
+            return -1;
+        }
+        return associativity;
+    }
+    return -1;
+}
+
+//Allocates and initializes a cache with the given size/associativity/blocksize/policy
+Cache* create_cache(int cache_size, int associativity, int block_size, int policy) {
+    Cache *cache = (Cache*)malloc(sizeof(Cache));
+    if (!cache) {
+        fprintf(stderr, "Error: malloc failed\n");
+        exit(1);
+    }
+
+    //Derive bit widths and set geometry from inputs
+    cache->block_size = block_size;
+    cache->block_bits = log2_int(block_size);
+    cache->set_lines = associativity;
+    cache->sets_num = cache_size / (associativity * block_size);
+    cache->set_bits = log2_int(cache->sets_num);
+    cache->policy = policy;
+
+    //Tree-PLRU stores its internal nodes (set_lines - 1 bits) in one word per set
+    if (policy == POLICY_PLRU && associativity > 64) {
+        fprintf(stderr, "Error: plru supports associativity up to 64\n");
+        exit(1);
+    }
+
+    //Replacement timestamps start at 0; first insertion stamps tick 1
+    cache->tick = 0;
+
+    //Initialize stats counters
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->reads = 0;
+    cache->writes = 0;
+
+    //Carve the structure-of-arrays line metadata out of one contiguous arena:
+    //packed tags and ages (sets_num * set_lines), the validity and dirty
+    //bitmasks, and the per-set policy words, each segment cache-line aligned.
+    //arena_map() zeroes the memory either way, so every arena starts with
+    //invalid lines whose tags cannot match a probe.
+    size_t total_lines = (size_t)cache->sets_num * (size_t)associativity;
+    cache->valid_words = (associativity + 63) / 64;
+    size_t lines_bytes = arena_align(total_lines * sizeof(unsigned long));
+    size_t mask_bytes = arena_align((size_t)cache->sets_num * cache->valid_words *
+                                    sizeof(unsigned long));
+    size_t meta_bytes = arena_align((size_t)cache->sets_num * sizeof(unsigned long));
+    cache->arena_bytes = 2 * lines_bytes + 2 * mask_bytes + meta_bytes;
+    cache->arena = arena_map(&cache->arena_bytes);
+    if (!cache->arena) {
+        fprintf(stderr, "Error: malloc failed\n");
+        exit(1);
+    }
+    char *base = (char*)cache->arena;
+    cache->tags = (unsigned long*)base;                     base += lines_bytes;
+    cache->ages = (unsigned long*)base;                     base += lines_bytes;
+    cache->valid = (unsigned long*)base;                    base += mask_bytes;
+    cache->dirty = (unsigned long*)base;                    base += mask_bytes;
+    cache->meta = (unsigned long*)base;
+
+    //Random replacement draws from a private deterministic xorshift stream
+    cache->rng = 0x2545F4914F6CDD1DUL;
+
+    //Per-set heatmap counters exist only in instrumented builds
+    cache->set_accesses = NULL;
+    cache->set_misses = NULL;
+    cache->set_evictions = NULL;
+#ifdef CACHESIM_SETSTATS
+    cache->set_accesses = (unsigned long*)calloc((size_t)cache->sets_num, sizeof(unsigned long));
+    cache->set_misses = (unsigned long*)calloc((size_t)cache->sets_num, sizeof(unsigned long));
+    cache->set_evictions = (unsigned long*)calloc((size_t)cache->sets_num, sizeof(unsigned long));
+    if (!cache->set_accesses || !cache->set_misses || !cache->set_evictions) {
+        fprintf(stderr, "Error: malloc failed\n");
+        exit(1);
+    }
+#endif
+
+    //Default memory model is write-through; main() flips this for --write-back
+    cache->write_back = 0;
+
+    //No pluggable prefetcher by default; demand misses use next-block prefetch
+    cache->prefetcher = NULL;
+
+    //No miss-path models by default; cache_set_misspath() attaches them
+    cache->misspath = NULL;
+
+    //Classic low-bits indexing; cache_set_index_hash() switches it
+    cache->index_hash = HASH_MASK;
+
+    //Dispatch: use a fully-unrolled kernel when the geometry is one of the
+    //specialized (set_lines, policy) pairs, otherwise the generic loop.
+    //Profiled builds force the generic path: the kernels inline probe/fill and
+    //would make per-stage attribution meaningless.
+#ifdef CACHESIM_PROFILE
+    (void)select_batch_kernel;
+    cache->batch_kernel = NULL;
+#else
+    cache->batch_kernel = select_batch_kernel(associativity, policy);
+#endif
+
+    return cache;
+}
+
+//Frees all dynamically allocated memory for a cache
+void free_cache(Cache *cache) {
+    if (cache->arena_bytes != 0) {
+        munmap(cache->arena, cache->arena_bytes);
+    } else {
+        free(cache->arena);
+    }
+    free(cache->set_accesses);
+    free(cache->set_misses);
+    free(cache->set_evictions);
+    free(cache);
+}
+
+void cache_set_index_hash(Cache *cache, int index_hash) {
+    cache->index_hash = index_hash;
+    if (index_hash == HASH_SKEW) {
+        //Skewed sets have no single set index per access: each way probes its
+        //own set, so the decoded-batch kernels cannot apply. Per-set policy
+        //state (PLRU trees, SRRIP aging) has no per-way equivalent here.
+        if (cache->policy != POLICY_LRU && cache->policy != POLICY_FIFO &&
+            cache->policy != POLICY_RANDOM) {
+            fprintf(stderr, "Error: skew indexing requires lru, fifo, or random\n");
+            exit(1);
+        }
+        cache->batch_kernel = NULL;
+    }
+}
+
+void cache_set_misspath(Cache *cache, struct MissPath *misspath) {
+    cache->misspath = misspath;
+    //The specialized kernels inline the miss path with no model hooks; the
+    //generic path pays the extra branch only on misses
+    cache->batch_kernel = NULL;
+}
+
+//Set-index hash: mask keeps the low bits, xor folds the bits above them back
+//in so power-of-two strides spread across sets. Invertible given the tag (low
+//bits = set ^ tag bits), which unhash_block_id below relies on.
+static inline unsigned long hash_set_index(const Cache *cache, unsigned long block_id) {
+    unsigned long mask = (cache->set_bits == 0) ? 0 : ((1UL << cache->set_bits) - 1);
+    if (cache->index_hash == HASH_XOR) {
+        return (block_id ^ (block_id >> cache->set_bits)) & mask;
+    }
+    return block_id & mask;
+}
+
+//Reconstructs a block id from a stored (set, tag) pair under the active hash
+static inline unsigned long unhash_block_id(const Cache *cache, unsigned long set_idx,
+                                            unsigned long tag) {
+    unsigned long mask = (cache->set_bits == 0) ? 0 : ((1UL << cache->set_bits) - 1);
+    unsigned long low = (cache->index_hash == HASH_XOR) ? ((set_idx ^ tag) & mask)
+                                                        : set_idx;
+    return (tag << cache->set_bits) | low;
+}
+
+//Per-way skewed index: each way xor-folds the upper bits with a different
+//shift, so blocks that conflict in one way spread out in the others
+static inline unsigned long skew_set_index(const Cache *cache, unsigned long block_id,
+                                           int way) {
+    unsigned long mask = (cache->set_bits == 0) ? 0 : ((1UL << cache->set_bits) - 1);
+    return (block_id ^ ((block_id >> cache->set_bits) >> way)) & mask;
+}
+
+//Computes block id by shifting off block offset bits
+unsigned long get_block_id(Cache *cache, unsigned long address) {
+    return address >> cache->block_bits;
+}
+
+//Computes set index from address under the cache's index hash
+unsigned long get_set_index(Cache *cache, unsigned long address) {
+    return hash_set_index(cache, get_block_id(cache, address));
+}
+
+//Computes tag by shifting off block offset bits and set index bits
+unsigned long get_tag(Cache *cache, unsigned long address) {
+    return address >> (cache->block_bits + cache->set_bits);
+}
+
+
+//Tests/sets/clears the validity bit of line i within a set's bitmask
+static inline int line_valid(const Cache *cache, unsigned long set_idx, int i) {
+    const unsigned long *words = &cache->valid[set_idx * (unsigned long)cache->valid_words];
+    return (int)((words[i >> 6] >> (i & 63)) & 1UL);
+}
+
+static inline void set_line_valid(Cache *cache, unsigned long set_idx, int i) {
+    unsigned long *words = &cache->valid[set_idx * (unsigned long)cache->valid_words];
+    words[i >> 6] |= 1UL << (i & 63);
+}
+
+//Dirty-bit accessors (write-back mode); same packed layout as the valid mask
+static inline int line_dirty(const Cache *cache, unsigned long set_idx, int i) {
+    const unsigned long *words = &cache->dirty[set_idx * (unsigned long)cache->valid_words];
+    return (int)((words[i >> 6] >> (i & 63)) & 1UL);
+}
+
+static inline void write_line_dirty(Cache *cache, unsigned long set_idx, int i, int dirty) {
+    unsigned long *words = &cache->dirty[set_idx * (unsigned long)cache->valid_words];
+    if (dirty) {
+        words[i >> 6] |= 1UL << (i & 63);
+    } else {
+        words[i >> 6] &= ~(1UL << (i & 63));
+    }
+}
+
+//Tree-PLRU helpers. The per-set word holds the internal nodes of a binary tree
+//in heap order (node 1 is the root); each bit points toward the pseudo-LRU
+//half of its subtree. Walks are O(log set_lines).
+
+//Follows the tree bits down to the pseudo-LRU line (set assumed full)
+static inline int plru_victim(unsigned long bits, int lines) {
+    int i = 1;
+    while (i < lines) {
+        i = 2 * i + (int)((bits >> i) & 1UL);
+    }
+    return i - lines;
+}
+
+//Flips the bits on the path to line_idx to point away from it (just accessed)
+static inline unsigned long plru_touch(unsigned long bits, int lines, int line_idx) {
+    int i = 1;
+    for (int b = log2_int((unsigned long)lines) - 1; b >= 0; b--) {
+        int dir = (line_idx >> b) & 1;
+        if (dir) {
+            bits &= ~(1UL << i);
+        } else {
+            bits |= 1UL << i;
+        }
+        i = 2 * i + dir;
+    }
+    return bits;
+}
+
+//SRRIP re-reference predictions live in the ages arena: 0 = near-immediate
+//re-reference (just hit), insertions start at 2, victims have RRPV 3
+#define SRRIP_MAX    3UL
+#define SRRIP_INSERT 2UL
+
+//Finds a line with the maximum RRPV, aging the whole set until one appears
+static inline int srrip_victim(unsigned long *ages, int lines) {
+    for (;;) {
+        for (int i = 0; i < lines; i++) {
+            if (ages[i] == SRRIP_MAX) {
+                return i;
+            }
+        }
+        for (int i = 0; i < lines; i++) {
+            ages[i]++;
+        }
+    }
+}
+
+//Draws a uniform victim line from the cache's xorshift stream (lines is a
+//power of two, so masking is unbiased)
+static inline int random_victim(Cache *cache, int lines) {
+    unsigned long x = cache->rng;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    cache->rng = x;
+    return (int)(x & (unsigned long)(lines - 1));
+}
+
+//Scans one set's packed tag array for a valid line matching tag; returns the
+//line index or -1. Vectorized when the compiler targets AVX2 or SSE2 (chosen
+//at build time): 4 (AVX2) or 2 (SSE2) tag compares per instruction, masked
+//against the set's validity bits.
+static int probe_set(const Cache *cache, unsigned long set_idx, unsigned long tag) {
+    const unsigned long *tags = &cache->tags[set_idx * (unsigned long)cache->set_lines];
+    const unsigned long *vwords = &cache->valid[set_idx * (unsigned long)cache->valid_words];
+    int set_lines = cache->set_lines;
+    int i = 0;
+
+#if defined(__AVX2__)
+    __m256i vtag = _mm256_set1_epi64x((long long)tag);
+    for (; i + 4 <= set_lines; i += 4) {
+        __m256i t = _mm256_loadu_si256((const __m256i*)&tags[i]);
+        __m256i eq = _mm256_cmpeq_epi64(t, vtag);
+        unsigned mask = (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(eq));
+        mask &= (unsigned)((vwords[i >> 6] >> (i & 63)) & 0xF);
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#elif defined(__SSE2__)
+    __m128i vtag = _mm_set1_epi64x((long long)tag);
+    for (; i + 2 <= set_lines; i += 2) {
+        __m128i t = _mm_loadu_si128((const __m128i*)&tags[i]);
+        //SSE2 has no 64-bit compare: compare 32-bit lanes, then require both
+        //halves of each 64-bit lane to match
+        __m128i eq32 = _mm_cmpeq_epi32(t, vtag);
+        __m128i eq64 = _mm_and_si128(eq32,
+                        _mm_shuffle_epi32(eq32, _MM_SHUFFLE(2, 3, 0, 1)));
+        unsigned mask = (unsigned)_mm_movemask_pd(_mm_castsi128_pd(eq64));
+        mask &= (unsigned)((vwords[i >> 6] >> (i & 63)) & 0x3);
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#endif
+
+    //Scalar tail (and full scan when no vector unit is targeted)
+    for (; i < set_lines; i++) {
+        if (((vwords[i >> 6] >> (i & 63)) & 1UL) && tags[i] == tag) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+//Searches for a matching valid line in the correct set; returns line index or -1 if miss
+int find_line(Cache *cache, unsigned long address, unsigned long *set_idx_out) {
+    unsigned long set_idx = get_set_index(cache, address);
+    unsigned long tag = get_tag(cache, address);
+    *set_idx_out = set_idx;
+    return probe_set(cache, set_idx, tag);
+}
+
+//Hit-side replacement update; FIFO and RANDOM track nothing on hits
+void update_lru_on_access(Cache *cache, unsigned long set_idx, int line_idx) {
+    switch (cache->policy) {
+        case POLICY_LRU:
+            //O(1) LRU: stamp the accessed line with a fresh global timestamp
+            //instead of re-aging every line in the set; recency order is the
+            //timestamp order, so victim choice is unchanged
+            cache->ages[set_idx * (unsigned long)cache->set_lines + line_idx] = ++cache->tick;
+            break;
+        case POLICY_PLRU:
+            cache->meta[set_idx] = plru_touch(cache->meta[set_idx],
+                                              cache->set_lines, line_idx);
+            break;
+        case POLICY_SRRIP:
+            cache->ages[set_idx * (unsigned long)cache->set_lines + line_idx] = 0;
+            break;
+        default:
+            break;
+    }
+}
+
+
+//Fills a line in the given set with the given tag, inserting into an empty line
+//or evicting the oldest-stamped one; callers pass the decode they already have.
+//In write-back mode an evicted dirty line counts a memory write (writeback) and
+//make_dirty sets the incoming line's dirty bit (write-allocate). If a valid
+//line was displaced its tag is stored in *evicted_tag_out (may be NULL) and
+//1 is returned, else 0.
+static int fill_set_line_evict(Cache *cache, unsigned long set_idx, unsigned long tag,
+                               int make_dirty, unsigned long *evicted_tag_out) {
+    unsigned long *tags = &cache->tags[set_idx * (unsigned long)cache->set_lines];
+    unsigned long *ages = &cache->ages[set_idx * (unsigned long)cache->set_lines];
+
+    //Find an invalid line first; otherwise ask the policy for a victim
+    int replace_idx = -1;
+    for (int i = 0; i < cache->set_lines; i++) {
+        if (!line_valid(cache, set_idx, i)) {
+            replace_idx = i;
+            break;
+        }
+    }
+    if (replace_idx < 0) {
+        switch (cache->policy) {
+            case POLICY_PLRU:
+                replace_idx = plru_victim(cache->meta[set_idx], cache->set_lines);
+                break;
+            case POLICY_SRRIP:
+                replace_idx = srrip_victim(ages, cache->set_lines);
+                break;
+            case POLICY_RANDOM:
+                replace_idx = random_victim(cache, cache->set_lines);
+                break;
+            default: {
+                //LRU/FIFO: evict the line with the oldest timestamp (smallest
+                //age): least recently used for LRU, first inserted for FIFO,
+                //since hits refresh the stamp only under LRU
+                unsigned long min_age = ages[0];
+                replace_idx = 0;
+                for (int i = 1; i < cache->set_lines; i++) {
+                    if (ages[i] < min_age) {
+                        min_age = ages[i];
+                        replace_idx = i;
+                    }
+                }
+                break;
+            }
+        }
+    }
+
+    //Report and write back the displaced line, if there was one
+    int evicted = line_valid(cache, set_idx, replace_idx);
+    if (evicted) {
+        SETSTAT_INC(cache->set_evictions, set_idx);
+        if (cache->write_back && line_dirty(cache, set_idx, replace_idx)) {
+            cache->writes++;
+        }
+        if (evicted_tag_out) {
+            *evicted_tag_out = tags[replace_idx];
+        }
+        if (cache->misspath) {
+            misspath_insert_victim(cache->misspath,
+                                   unhash_block_id(cache, set_idx, tags[replace_idx]));
+        }
+    }
+
+    //Insert/replace the chosen line and stamp the policy's insertion state;
+    //no other line's metadata needs touching
+    set_line_valid(cache, set_idx, replace_idx);
+    write_line_dirty(cache, set_idx, replace_idx, make_dirty);
+    tags[replace_idx] = tag;
+    switch (cache->policy) {
+        case POLICY_PLRU:
+            cache->meta[set_idx] = plru_touch(cache->meta[set_idx],
+                                              cache->set_lines, replace_idx);
+            break;
+        case POLICY_SRRIP:
+            ages[replace_idx] = SRRIP_INSERT;
+            break;
+        case POLICY_RANDOM:
+            break;
+        default:
+            ages[replace_idx] = ++cache->tick;
+            break;
+    }
+    return evicted;
+}
+
+//Fill without eviction reporting (the common demand/prefetch path)
+static void fill_set_line(Cache *cache, unsigned long set_idx, unsigned long tag,
+                          int make_dirty) {
+    fill_set_line_evict(cache, set_idx, tag, make_dirty, NULL);
+}
+
+//Loads a block into cache by inserting into an empty line or evicting the oldest
+void load_block(Cache *cache, unsigned long address) {
+    fill_set_line(cache, get_set_index(cache, address), get_tag(cache, address), 0);
+}
+
+//Probe-and-fill against an already-decoded set/tag; updates LRU on a hit and
+//tracks dirty state for writes in write-back mode. Returns 1 on hit, 0 on miss.
+static int access_set(Cache *cache, unsigned long set_idx, unsigned long tag,
+                      int is_write) {
+    SETSTAT_INC(cache->set_accesses, set_idx);
+    PROBE_BEGIN(PROBE_PROBE);
+    int line_idx = probe_set(cache, set_idx, tag);
+    PROBE_END(PROBE_PROBE);
+    if (line_idx != -1) {
+        PROBE_BEGIN(PROBE_LRU);
+        update_lru_on_access(cache, set_idx, line_idx);
+        PROBE_END(PROBE_LRU);
+        if (is_write && cache->write_back) {
+            write_line_dirty(cache, set_idx, line_idx, 1);
+        }
+        return 1;
+    }
+    SETSTAT_INC(cache->set_misses, set_idx);
+    PROBE_BEGIN(PROBE_FILL);
+    fill_set_line(cache, set_idx, tag, is_write && cache->write_back);
+    PROBE_END(PROBE_FILL);
+    return 0;
+}
+
+//Skewed probe: way w is searched at its own set index, so stored tags hold the
+//full block id (a (set, tag) pair no longer identifies a block across ways).
+//Returns 1 with the hit slot's set/way, 0 on a miss.
+static int skew_probe(Cache *cache, unsigned long block_id,
+                      unsigned long *set_out, int *way_out) {
+    for (int w = 0; w < cache->set_lines; w++) {
+        unsigned long set_idx = skew_set_index(cache, block_id, w);
+        if (line_valid(cache, set_idx, w) &&
+            cache->tags[set_idx * (unsigned long)cache->set_lines + w] == block_id) {
+            *set_out = set_idx;
+            *way_out = w;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+//Skewed fill: invalid way first, then the policy's victim across the per-way
+//candidate slots (LRU/FIFO timestamps are globally comparable, random picks a
+//way). If a valid block was displaced its id is stored in *evicted_block
+//(may be NULL) and 1 is returned, else 0.
+static int skew_fill(Cache *cache, unsigned long block_id, int make_dirty,
+                     unsigned long *evicted_block) {
+    int way = -1;
+    for (int w = 0; w < cache->set_lines; w++) {
+        if (!line_valid(cache, skew_set_index(cache, block_id, w), w)) {
+            way = w;
+            break;
+        }
+    }
+    if (way < 0) {
+        if (cache->policy == POLICY_RANDOM) {
+            way = random_victim(cache, cache->set_lines);
+        } else {
+            unsigned long min_age = 0;
+            for (int w = 0; w < cache->set_lines; w++) {
+                unsigned long set_idx = skew_set_index(cache, block_id, w);
+                unsigned long age = cache->ages[set_idx * (unsigned long)cache->set_lines + w];
+                if (way < 0 || age < min_age) {
+                    min_age = age;
+                    way = w;
+                }
+            }
+        }
+    }
+
+    unsigned long set_idx = skew_set_index(cache, block_id, way);
+    unsigned long slot = set_idx * (unsigned long)cache->set_lines + (unsigned long)way;
+    int evicted = line_valid(cache, set_idx, way);
+    if (evicted) {
+        SETSTAT_INC(cache->set_evictions, set_idx);
+        if (cache->write_back && line_dirty(cache, set_idx, way)) {
+            cache->writes++;
+        }
+        if (evicted_block) {
+            *evicted_block = cache->tags[slot];
+        }
+        if (cache->misspath) {
+            misspath_insert_victim(cache->misspath, cache->tags[slot]);
+        }
+    }
+    set_line_valid(cache, set_idx, way);
+    write_line_dirty(cache, set_idx, way, make_dirty);
+    cache->tags[slot] = block_id;
+    if (cache->policy != POLICY_RANDOM) {
+        cache->ages[slot] = ++cache->tick;
+    }
+    return evicted;
+}
+
+//Skewed probe-and-fill for a demand access; stat semantics match access_set
+static int skew_access(Cache *cache, unsigned long block_id, int is_write) {
+    unsigned long set_idx;
+    int way;
+    SETSTAT_INC(cache->set_accesses, skew_set_index(cache, block_id, 0));
+    if (skew_probe(cache, block_id, &set_idx, &way)) {
+        update_lru_on_access(cache, set_idx, way);
+        if (is_write && cache->write_back) {
+            write_line_dirty(cache, set_idx, way, 1);
+        }
+        return 1;
+    }
+    SETSTAT_INC(cache->set_misses, skew_set_index(cache, block_id, 0));
+    skew_fill(cache, block_id, is_write && cache->write_back, NULL);
+    return 0;
+}
+
+//Combined probe-and-fill for a demand access: decodes the address exactly once,
+//probes, updates LRU on a hit, and on a miss fills the set using the decode the
+//probe already computed. Returns 1 on hit, 0 on miss.
+int cache_access(Cache *cache, unsigned long address) {
+    unsigned long block_id = address >> cache->block_bits;
+    if (cache->index_hash == HASH_SKEW) {
+        return skew_access(cache, block_id, 0);
+    }
+    unsigned long set_idx = hash_set_index(cache, block_id);
+    unsigned long tag = block_id >> cache->set_bits;
+    return access_set(cache, set_idx, tag, 0);
+}
+
+//Prefetches the next sequential block (block_id+1) if not already present;
+//a prefetch hit does not refresh LRU (same as before)
+void prefetch_next(Cache *cache, unsigned long address) {
+    cache_prefetch_block(cache, (address >> cache->block_bits) + 1);
+}
+
+//Memory-read accounting for a demand miss: when miss-path models are attached
+//a victim-buffer hit or a coalesced MSHR fill absorbs the read
+static inline void miss_memory_read(Cache *cache, unsigned long block_id) {
+    if (!cache->misspath || misspath_memory_read(cache->misspath, block_id)) {
+        cache->reads++;
+    }
+}
+
+//Simulates a read access; on miss loads block and optionally prefetches next
+void simulate_read(Cache *cache, unsigned long address, int prefetch) {
+    if (cache_access(cache, address)) {
+        //Cache hit
+        cache->hits++;
+    } else {
+        //Cache miss: memory read for demand fetch (block already loaded)
+        cache->misses++;
+        miss_memory_read(cache, address >> cache->block_bits);
+        if (prefetch) {
+            prefetch_next(cache, address);
+        }
+    }
+}
+
+//Simulates a write access: write-through counts every write as memory traffic;
+//write-back only dirties the line and pays the memory write on eviction
+void simulate_write(Cache *cache, unsigned long address, int prefetch) {
+    unsigned long block_id = address >> cache->block_bits;
+    int hit = (cache->index_hash == HASH_SKEW)
+        ? skew_access(cache, block_id, 1)
+        : access_set(cache, hash_set_index(cache, block_id),
+                     block_id >> cache->set_bits, 1);
+    if (hit) {
+        //Cache hit: count write (write-through only)
+        cache->hits++;
+        if (!cache->write_back) cache->writes++;
+    } else {
+        //Cache miss: fetch block (read), then perform the write; optionally prefetch next
+        cache->misses++;
+        miss_memory_read(cache, block_id);
+        if (!cache->write_back) cache->writes++;
+        if (prefetch) {
+            prefetch_next(cache, address);
+        }
+    }
+}
+
+//Simulates a block of decoded records in one call. The prefetch branch is
+//hoisted out of the loop (one loop body per mode), so the inner loop is just
+//decode + probe + counter updates with the Cache pointer pinned in a register.
+void simulate_batch(Cache *cache, const TraceRecord *recs, size_t n, int prefetch) {
+    if (prefetch) {
+        for (size_t i = 0; i < n; i++) {
+            if (recs[i].op == 'R') {
+                simulate_read(cache, recs[i].address, 1);
+            } else if (recs[i].op == 'W') {
+                simulate_write(cache, recs[i].address, 1);
+            }
+        }
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            if (recs[i].op == 'R') {
+                simulate_read(cache, recs[i].address, 0);
+            } else if (recs[i].op == 'W') {
+                simulate_write(cache, recs[i].address, 0);
+            }
+        }
+    }
+}
+
+void decode_batch(const Cache *cache, const TraceRecord *recs, size_t n,
+                  DecodedRecord *out) {
+    int block_bits = cache->block_bits;
+    int set_bits = cache->set_bits;
+    unsigned long mask = (set_bits == 0) ? 0 : ((1UL << set_bits) - 1);
+
+    //XOR folding happens here, once per record, so the batch kernels see the
+    //hashed set index and need no changes
+    if (cache->index_hash == HASH_XOR) {
+        for (size_t i = 0; i < n; i++) {
+            unsigned long block_id = recs[i].address >> block_bits;
+            out[i].block_id = block_id;
+            out[i].set_idx = (block_id ^ (block_id >> set_bits)) & mask;
+            out[i].tag = block_id >> set_bits;
+            out[i].pc = recs[i].pc;
+            out[i].op = recs[i].op;
+        }
+        return;
+    }
+    for (size_t i = 0; i < n; i++) {
+        unsigned long block_id = recs[i].address >> block_bits;
+        out[i].block_id = block_id;
+        out[i].set_idx = block_id & mask;
+        out[i].tag = block_id >> set_bits;
+        out[i].pc = recs[i].pc;
+        out[i].op = recs[i].op;
+    }
+}
+
+//Block-level helpers for the hierarchy engine: each decodes its block id once
+//for this cache's geometry and reuses the probe-and-fill internals.
+
+//Probes for a block without filling; refreshes LRU on a hit when update_lru is set
+int cache_probe_block(Cache *cache, unsigned long block_id, int update_lru) {
+    unsigned long set_idx;
+    int line_idx;
+    if (cache->index_hash == HASH_SKEW) {
+        if (!skew_probe(cache, block_id, &set_idx, &line_idx)) {
+            return 0;
+        }
+    } else {
+        set_idx = hash_set_index(cache, block_id);
+        line_idx = probe_set(cache, set_idx, block_id >> cache->set_bits);
+        if (line_idx == -1) {
+            return 0;
+        }
+    }
+    if (update_lru) {
+        update_lru_on_access(cache, set_idx, line_idx);
+    }
+    return 1;
+}
+
+//Inserts a block; if a valid block was displaced, stores its block id in
+//*evicted_block (for exclusive victim handling) and returns 1
+int cache_insert_block(Cache *cache, unsigned long block_id, unsigned long *evicted_block) {
+    if (cache->index_hash == HASH_SKEW) {
+        return skew_fill(cache, block_id, 0, evicted_block);
+    }
+    unsigned long set_idx = hash_set_index(cache, block_id);
+    unsigned long evicted_tag;
+    if (fill_set_line_evict(cache, set_idx, block_id >> cache->set_bits, 0, &evicted_tag)) {
+        if (evicted_block) {
+            *evicted_block = unhash_block_id(cache, set_idx, evicted_tag);
+        }
+        return 1;
+    }
+    return 0;
+}
+
+//Drops a block from the cache if present (exclusive move-to-upper-level)
+void cache_invalidate_block(Cache *cache, unsigned long block_id) {
+    unsigned long set_idx;
+    int line_idx;
+    if (cache->index_hash == HASH_SKEW) {
+        if (!skew_probe(cache, block_id, &set_idx, &line_idx)) {
+            return;
+        }
+    } else {
+        set_idx = hash_set_index(cache, block_id);
+        line_idx = probe_set(cache, set_idx, block_id >> cache->set_bits);
+        if (line_idx == -1) {
+            return;
+        }
+    }
+    unsigned long *words = &cache->valid[set_idx * (unsigned long)cache->valid_words];
+    words[line_idx >> 6] &= ~(1UL << (line_idx & 63));
+    write_line_dirty(cache, set_idx, line_idx, 0);
+}
+
+//Prefetch issue path shared by all engines: one probe, one fill on absence
+void cache_prefetch_block(Cache *cache, unsigned long block_id) {
+    PROBE_BEGIN(PROBE_PREFETCH);
+    if (cache->index_hash == HASH_SKEW) {
+        unsigned long set_idx;
+        int way;
+        if (!skew_probe(cache, block_id, &set_idx, &way)) {
+            cache->reads++;
+            skew_fill(cache, block_id, 0, NULL);
+        }
+    } else {
+        unsigned long set_idx = hash_set_index(cache, block_id);
+        unsigned long tag = block_id >> cache->set_bits;
+        if (probe_set(cache, set_idx, tag) == -1) {
+            cache->reads++;
+            fill_set_line(cache, set_idx, tag, 0);
+        }
+    }
+    PROBE_END(PROBE_PREFETCH);
+}
+
+//Demand-miss prefetch hook: route through the configured engine when one is
+//attached, otherwise the classic next-block (block_id+1) prefetch
+static void prefetch_on_miss_decoded(Cache *cache, unsigned long pc,
+                                     unsigned long block_id) {
+    if (cache->prefetcher) {
+        prefetcher_on_miss(cache->prefetcher, cache, pc, block_id);
+    } else {
+        cache_prefetch_block(cache, block_id + 1);
+    }
+}
+
+//One pre-decoded record through the read or write path; stat semantics are
+//identical to simulate_read/simulate_write
+static void simulate_decoded_one(Cache *cache, const DecodedRecord *rec, int prefetch) {
+    if (cache->index_hash == HASH_SKEW) {
+        //Skewed indexing ignores the pre-decoded set/tag: each way rehashes
+        if (rec->op != 'R' && rec->op != 'W') {
+            return;
+        }
+        int is_write = (rec->op == 'W');
+        if (skew_access(cache, rec->block_id, is_write)) {
+            cache->hits++;
+            if (is_write && !cache->write_back) cache->writes++;
+        } else {
+            cache->misses++;
+            miss_memory_read(cache, rec->block_id);
+            if (is_write && !cache->write_back) cache->writes++;
+            if (prefetch) {
+                prefetch_on_miss_decoded(cache, rec->pc, rec->block_id);
+            }
+        }
+        return;
+    }
+    if (rec->op == 'R') {
+        if (access_set(cache, rec->set_idx, rec->tag, 0)) {
+            cache->hits++;
+        } else {
+            cache->misses++;
+            miss_memory_read(cache, rec->block_id);
+            if (prefetch) {
+                prefetch_on_miss_decoded(cache, rec->pc, rec->block_id);
+            }
+        }
+    } else if (rec->op == 'W') {
+        if (access_set(cache, rec->set_idx, rec->tag, 1)) {
+            cache->hits++;
+            if (!cache->write_back) cache->writes++;
+        } else {
+            cache->misses++;
+            miss_memory_read(cache, rec->block_id);
+            if (!cache->write_back) cache->writes++;
+            if (prefetch) {
+                prefetch_on_miss_decoded(cache, rec->pc, rec->block_id);
+            }
+        }
+    }
+}
+
+//Specialized kernels for the common geometries (>90% of production sweeps):
+//direct-mapped and 2/4/8-way, FIFO and LRU. Each expansion of the template
+//gets constant SET_LINES/POLICY, so the probe and victim scans fully unroll.
+#define CACHE_KERN_NAME kern_lines1_fifo
+#define CACHE_KERN_LINES 1
+#define CACHE_KERN_POLICY POLICY_FIFO
+#include "cache_kernel.inc"
+#define CACHE_KERN_NAME kern_lines1_lru
+#define CACHE_KERN_LINES 1
+#define CACHE_KERN_POLICY POLICY_LRU
+#include "cache_kernel.inc"
+#define CACHE_KERN_NAME kern_lines2_fifo
+#define CACHE_KERN_LINES 2
+#define CACHE_KERN_POLICY POLICY_FIFO
+#include "cache_kernel.inc"
+#define CACHE_KERN_NAME kern_lines2_lru
+#define CACHE_KERN_LINES 2
+#define CACHE_KERN_POLICY POLICY_LRU
+#include "cache_kernel.inc"
+#define CACHE_KERN_NAME kern_lines4_fifo
+#define CACHE_KERN_LINES 4
+#define CACHE_KERN_POLICY POLICY_FIFO
+#include "cache_kernel.inc"
+#define CACHE_KERN_NAME kern_lines4_lru
+#define CACHE_KERN_LINES 4
+#define CACHE_KERN_POLICY POLICY_LRU
+#include "cache_kernel.inc"
+#define CACHE_KERN_NAME kern_lines8_fifo
+#define CACHE_KERN_LINES 8
+#define CACHE_KERN_POLICY POLICY_FIFO
+#include "cache_kernel.inc"
+#define CACHE_KERN_NAME kern_lines8_lru
+#define CACHE_KERN_LINES 8
+#define CACHE_KERN_POLICY POLICY_LRU
+#include "cache_kernel.inc"
+#define CACHE_KERN_NAME kern_lines4_plru
+#define CACHE_KERN_LINES 4
+#define CACHE_KERN_POLICY POLICY_PLRU
+#include "cache_kernel.inc"
+#define CACHE_KERN_NAME kern_lines8_plru
+#define CACHE_KERN_LINES 8
+#define CACHE_KERN_POLICY POLICY_PLRU
+#include "cache_kernel.inc"
+#define CACHE_KERN_NAME kern_lines4_srrip
+#define CACHE_KERN_LINES 4
+#define CACHE_KERN_POLICY POLICY_SRRIP
+#include "cache_kernel.inc"
+#define CACHE_KERN_NAME kern_lines8_srrip
+#define CACHE_KERN_LINES 8
+#define CACHE_KERN_POLICY POLICY_SRRIP
+#include "cache_kernel.inc"
+#define CACHE_KERN_NAME kern_lines4_random
+#define CACHE_KERN_LINES 4
+#define CACHE_KERN_POLICY POLICY_RANDOM
+#include "cache_kernel.inc"
+#define CACHE_KERN_NAME kern_lines8_random
+#define CACHE_KERN_LINES 8
+#define CACHE_KERN_POLICY POLICY_RANDOM
+#include "cache_kernel.inc"
+
+//Picks the specialized kernel for this configuration, or NULL for the generic path
+static CacheBatchKernel select_batch_kernel(int set_lines, int policy) {
+    if (policy == POLICY_FIFO) {
+        switch (set_lines) {
+            case 1: return kern_lines1_fifo;
+            case 2: return kern_lines2_fifo;
+            case 4: return kern_lines4_fifo;
+            case 8: return kern_lines8_fifo;
+        }
+    } else if (policy == POLICY_LRU) {
+        switch (set_lines) {
+            case 1: return kern_lines1_lru;
+            case 2: return kern_lines2_lru;
+            case 4: return kern_lines4_lru;
+            case 8: return kern_lines8_lru;
+        }
+    } else if (policy == POLICY_PLRU) {
+        switch (set_lines) {
+            case 4: return kern_lines4_plru;
+            case 8: return kern_lines8_plru;
+        }
+    } else if (policy == POLICY_SRRIP) {
+        switch (set_lines) {
+            case 4: return kern_lines4_srrip;
+            case 8: return kern_lines8_srrip;
+        }
+    } else if (policy == POLICY_RANDOM) {
+        switch (set_lines) {
+            case 4: return kern_lines4_random;
+            case 8: return kern_lines8_random;
+        }
+    }
+    return NULL;
+}
+
+void simulate_batch_decoded(Cache *cache, const DecodedRecord *recs, size_t n,
+                            int prefetch) {
+    //Specialized kernels handle whole batches, so the indirect call is paid
+    //once per batch rather than per access
+    if (cache->batch_kernel) {
+        cache->batch_kernel(cache, recs, n, prefetch);
+        return;
+    }
+    if (prefetch) {
+        for (size_t i = 0; i < n; i++) {
+            simulate_decoded_one(cache, &recs[i], 1);
+        }
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            simulate_decoded_one(cache, &recs[i], 0);
+        }
+    }
+}
+
+//Per-set heatmap report: distribution summary plus the top_k sets ranked by
+//misses, for steering index-hashing decisions. Counter collection is compiled
+//in by -DCACHESIM_SETSTATS (make SETSTATS=1).
+void print_set_stats(Cache *cache, int prefetch, int top_k) {
+    if (!cache->set_accesses) {
+        printf("Set stats unavailable: rebuild with SETSTATS=1\n");
+        return;
+    }
+
+    int sets = cache->sets_num;
+    unsigned long max_misses = 0, total_misses = 0;
+    int nonzero_sets = 0;
+    for (int s = 0; s < sets; s++) {
+        total_misses += cache->set_misses[s];
+        if (cache->set_misses[s] > max_misses) {
+            max_misses = cache->set_misses[s];
+        }
+        if (cache->set_accesses[s] > 0) {
+            nonzero_sets++;
+        }
+    }
+
+    printf("Set stats (prefetch %d): %d sets, %d touched, "
+           "mean misses/set %.1f, max misses/set %lu\n",
+           prefetch, sets, nonzero_sets,
+           sets > 0 ? (double)total_misses / (double)sets : 0.0, max_misses);
+
+    //Top-K conflict sets by miss count (selection scan; top_k is small)
+    printf("%8s %12s %12s %12s %10s\n",
+           "set", "accesses", "misses", "evictions", "miss_rate");
+    unsigned long floor_misses = (unsigned long)-1;
+    int floor_set = -1;
+    for (int k = 0; k < top_k; k++) {
+        int best = -1;
+        unsigned long best_misses = 0;
+        for (int s = 0; s < sets; s++) {
+            unsigned long m = cache->set_misses[s];
+            //Skip reported sets: higher counts, or the same count at an index
+            //already emitted (ties break by set index, so order is stable)
+            if (m == 0 || m > floor_misses ||
+                (m == floor_misses && s <= floor_set)) {
+                continue;
+            }
+            if (best == -1 || m > best_misses) {
+                best_misses = m;
+                best = s;
+            }
+        }
+        if (best == -1) {
+            break;
+        }
+        printf("%8d %12lu %12lu %12lu %9.1f%%\n",
+               best, cache->set_accesses[best], cache->set_misses[best],
+               cache->set_evictions[best],
+               100.0 * (double)cache->set_misses[best] /
+                       (double)cache->set_accesses[best]);
+        floor_misses = best_misses;
+        floor_set = best;
+    }
+}
+
+//Prints the required output stats for one simulation run
+void print_stats(Cache *cache, int prefetch) {
+    printf("Prefetch %d\n", prefetch);
+    printf("Memory reads: %lu\n", cache->reads);
+    printf("Memory writes: %lu\n", cache->writes);
+    printf("Cache hits: %lu\n", cache->hits);
+    printf("Cache misses: %lu\n", cache->misses);
+}
@@ -0,0 +1,182 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stddef.h>
+
+#include "trace_reader.h"
+
+//DecodedRecord is a trace record pre-decoded for one cache geometry
+//(block_bits/set_bits); caches sharing a geometry can share one decode.
+//The pc rides along for PC-correlated prefetcher engines.
+typedef struct {
+    unsigned long block_id;
+    unsigned long set_idx;
+    unsigned long tag;
+    unsigned long pc;
+    char op;
+} DecodedRecord;
+
+typedef struct Cache Cache;
+struct Prefetcher;
+struct MissPath;
+
+//Specialized batch kernel for a fixed (set_lines, policy) pair, selected once
+//at create_cache() time; NULL means the generic path is used
+typedef void (*CacheBatchKernel)(Cache *cache, const DecodedRecord *recs,
+                                 size_t n, int prefetch);
+
+//Cache stores configuration, stats, and the line metadata as structure-of-arrays:
+//tags and ages are contiguous arenas indexed set_idx * set_lines + i, and line
+//validity is a packed bitmask (valid_words 64-bit words per set). The packed tag
+//array lets a set probe compare several tags per vector instruction instead of
+//walking an array of structs one line at a time.
+struct Cache {
+    int sets_num;
+    int set_lines;
+    int block_size;
+    int block_bits;
+    int set_bits;
+    int policy;
+    int valid_words;        //64-bit bitmask words per set
+    unsigned long tick;     //global monotonic timestamp for replacement ordering
+    int write_back;         //1 = write-back/write-allocate, 0 = write-through
+    void *arena;            //single backing allocation carved into the arrays below
+    size_t arena_bytes;     //mapped length; 0 means the arena came from malloc
+    unsigned long *tags;    //sets_num * set_lines
+    unsigned long *ages;    //sets_num * set_lines (LRU/FIFO timestamps; SRRIP RRPVs)
+    unsigned long *valid;   //sets_num * valid_words bitmask
+    unsigned long *dirty;   //sets_num * valid_words bitmask (write-back mode)
+    unsigned long *meta;    //sets_num words of per-set policy state (PLRU tree bits)
+    unsigned long rng;      //xorshift state for random replacement
+    int index_hash;         //set-index function (HASH_MASK/HASH_XOR/HASH_SKEW)
+    //Per-set heatmap counters, allocated only in -DCACHESIM_SETSTATS builds
+    //(NULL otherwise); SETSTAT_INC() compiles out with them
+    unsigned long *set_accesses;
+    unsigned long *set_misses;
+    unsigned long *set_evictions;
+    CacheBatchKernel batch_kernel;  //specialized kernel, or NULL for generic
+    struct Prefetcher *prefetcher;  //pluggable engine; NULL means next-block
+    struct MissPath *misspath;      //victim/MSHR models; NULL means none
+
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long reads;
+    unsigned long writes;
+};
+
+//Set-index functions. MASK is the classic low-bits modulo; XOR folds the bits
+//above the set index back in (one xor at decode time, so the specialized
+//kernels are unaffected); SKEW gives every way its own index function, which
+//needs a per-way probe and therefore runs on the generic path.
+enum {
+    HASH_MASK = 0,
+    HASH_XOR  = 1,
+    HASH_SKEW = 2
+};
+
+//One indexed add on paths that already touch the set's metadata; a no-op in
+//default builds so the hot path stays lean
+#ifdef CACHESIM_SETSTATS
+#define SETSTAT_INC(counter, set_idx) ((counter)[set_idx]++)
+#else
+#define SETSTAT_INC(counter, set_idx)
+#endif
+
+//Replacement policy identifiers. LRU/FIFO order lines by timestamp; PLRU keeps
+//tree bits per set (O(log assoc) updates); SRRIP keeps 2-bit re-reference
+//predictions per line; RANDOM picks victims from a deterministic xorshift.
+enum {
+    POLICY_FIFO   = 0,
+    POLICY_LRU    = 1,
+    POLICY_PLRU   = 2,
+    POLICY_SRRIP  = 3,
+    POLICY_RANDOM = 4
+};
+
+//Returns 1 if x is a power of two, else 0 (used to validate CLI args)
+int is_power_of_two(unsigned long x);
+
+//Integer log2 for powers of two (counts how many bits needed to represent x)
+int log2_int(unsigned long x);
+
+//Parses a policy string (fifo/lru/plru/srrip/random); returns the policy id
+//or -1 if invalid
+int parse_policy(const char *policy_str);
+
+//Parses an associativity spec (direct | assoc | assoc:n); returns the number of
+//lines per set or -1 if invalid
+int parse_associativity(const char *assoc_str, int cache_size, int block_size);
+
+//Allocates and initializes a cache with the given size/associativity/blocksize/policy
+Cache* create_cache(int cache_size, int associativity, int block_size, int policy);
+
+//Parses an index-hash string (mask/xor/skew); returns the hash id or -1 if invalid
+int parse_index_hash(const char *hash_str);
+
+//Selects the set-index function; must be called before simulation starts.
+//Skewed indexing requires an lru/fifo/random policy and runs the generic path.
+void cache_set_index_hash(Cache *cache, int index_hash);
+
+//Attaches the victim-cache/MSHR miss-path models; must be called before
+//simulation starts (the cache runs the generic path so only misses pay)
+void cache_set_misspath(Cache *cache, struct MissPath *misspath);
+
+//Frees all dynamically allocated memory for a cache
+void free_cache(Cache *cache);
+
+//Address decode helpers (block id, set index, tag)
+unsigned long get_block_id(Cache *cache, unsigned long address);
+unsigned long get_set_index(Cache *cache, unsigned long address);
+unsigned long get_tag(Cache *cache, unsigned long address);
+
+//Searches for a matching valid line in the correct set; returns line index or -1 if miss
+int find_line(Cache *cache, unsigned long address, unsigned long *set_idx_out);
+
+//Combined probe-and-fill for a demand access: decodes the address once, updates
+//LRU on a hit, fills the set on a miss; returns 1 on hit, 0 on miss
+int cache_access(Cache *cache, unsigned long address);
+
+//Updates replacement metadata after a hit (FIFO and RANDOM are no-ops)
+void update_lru_on_access(Cache *cache, unsigned long set_idx, int line_idx);
+
+//Loads a block into cache by inserting into an empty line or evicting by age
+void load_block(Cache *cache, unsigned long address);
+
+//Prefetches the next sequential block (block_id+1) if not already present
+void prefetch_next(Cache *cache, unsigned long address);
+
+//Prefetch issue path shared by all prefetcher engines: probes the given block
+//and, if absent, counts a memory read and fills it (no LRU refresh on a hit)
+void cache_prefetch_block(Cache *cache, unsigned long block_id);
+
+//Block-level helpers for the hierarchy engine
+int cache_probe_block(Cache *cache, unsigned long block_id, int update_lru);
+int cache_insert_block(Cache *cache, unsigned long block_id, unsigned long *evicted_block);
+void cache_invalidate_block(Cache *cache, unsigned long block_id);
+
+//Simulates a read access; on miss loads block and optionally prefetches next
+void simulate_read(Cache *cache, unsigned long address, int prefetch);
+
+//Simulates a write access (write-through, write-allocate style behavior)
+void simulate_write(Cache *cache, unsigned long address, int prefetch);
+
+//Simulates a block of decoded trace records in one call, keeping the cache
+//state hot and hoisting the prefetch branch out of the per-record loop
+void simulate_batch(Cache *cache, const TraceRecord *recs, size_t n, int prefetch);
+
+//Decodes a batch of records for this cache's geometry
+void decode_batch(const Cache *cache, const TraceRecord *recs, size_t n,
+                  DecodedRecord *out);
+
+//Simulates a batch of pre-decoded records; semantics match simulate_batch
+void simulate_batch_decoded(Cache *cache, const DecodedRecord *recs, size_t n,
+                            int prefetch);
+
+//Prints the required output stats for one simulation run
+void print_stats(Cache *cache, int prefetch);
+
+//Prints the per-set access/miss/eviction distribution and the top_k sets with
+//the most misses (requires a -DCACHESIM_SETSTATS build; says so otherwise)
+void print_set_stats(Cache *cache, int prefetch, int top_k);
+
+#endif
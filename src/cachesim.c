@@ -1,349 +1,591 @@
+//cachesim entry point: argument parsing and the default two-run (prefetch
+//off/on) simulation. The cache model lives in cache.c, trace decoding in
+//trace_reader.c, and multi-configuration sweeps in sweep.c.
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-//CacheLine represents a single cache line within a set (valid bit + tag + replacement metadata)
-typedef struct {
-    int valid;
-    unsigned long tag;
-    unsigned long age;   //age within the set
-} CacheLine;
+#include "cache.h"
+#include "trace_reader.h"
+#include "sweep.h"
+#include "prefetch.h"
+#include "hierarchy.h"
+#include "partition.h"
+#include "reuse.h"
+#include "interval.h"
+#include "probe.h"
+#include "checkpoint.h"
+#include "results.h"
+#include "tlb.h"
+#include "misspath.h"
+#include "pipeline.h"
+
+//Records per simulate_batch() call in the default two-run mode
+#define BATCH_RECORDS 4096
 
-//Cache stores cache configuration, stats, and the 2D array of cache lines (sets x lines)
-typedef struct {
-    int sets_num;
-    int set_lines;
-    int block_size;
-    int block_bits;
-    int set_bits;
-    int policy;         
-    CacheLine **lines;
-
-    unsigned long hits;
-    unsigned long misses;
-    unsigned long reads;
-    unsigned long writes;
-} Cache;
-
-//Replacement policy identifiers
-enum {
-    POLICY_FIFO = 0,
-    POLICY_LRU  = 1
-};
-
-//Returns 1 if x is a power of two, else 0 (used to validate CLI args)
-int is_power_of_two(unsigned long x) {
-    return x != 0 && (x & (x - 1)) == 0;
-}
-
-//Integer log2 for powers of two (counts how many bits needed to represent x)
-int log2_int(unsigned long x) {
-    int count = 0;
-    while (x > 1) {
-        x >>= 1;
-        count++;
-    }
-    return count;
-}
-
-//Allocates and initializes a cache with the given size/associativity/blocksize/policy
-Cache* create_cache(int cache_size, int associativity, int block_size, int policy) {
-    Cache *cache = (Cache*)malloc(sizeof(Cache));
-    if (!cache) {
-        fprintf(stderr, "Error: malloc failed\n");
-        exit(1);
-    }
-
-    //Derive bit widths and set geometry from inputs
-    cache->block_size = block_size;
-    cache->block_bits = log2_int(block_size);
-    cache->set_lines = associativity;
-    cache->sets_num = cache_size / (associativity * block_size);
-    cache->set_bits = log2_int(cache->sets_num);
-    cache->policy = policy;
-
-    //Initialize stats counters
-    cache->hits = 0;
-    cache->misses = 0;
-    cache->reads = 0;
-    cache->writes = 0;
-
-    //Allocate array of sets (each set points to an array of CacheLine)
-    cache->lines = (CacheLine**)malloc(cache->sets_num * sizeof(CacheLine*));
-    if (!cache->lines) {
-        fprintf(stderr, "Error: malloc failed\n");
-        exit(1);
+int main(int argc, char *argv[]) {
+    //Converter mode: translate a text trace to the packed binary format once,
+    //so sweep runs can replay it without re-parsing hex ASCII
+    if (argc == 4 && strcmp(argv[1], "--convert") == 0) {
+        return trace_convert(argv[2], argv[3]);
     }
 
-    //Allocate each set and initialize lines to invalid
-    for (int i = 0; i < cache->sets_num; i++) {
-        cache->lines[i] = (CacheLine*)malloc(associativity * sizeof(CacheLine));
-        if (!cache->lines[i]) {
-            fprintf(stderr, "Error: malloc failed\n");
-            exit(1);
-        }
-        for (int j = 0; j < associativity; j++) {
-            cache->lines[i][j].valid = 0;
-            cache->lines[i][j].tag = 0;
-            cache->lines[i][j].age = 0;
+    //Sweep mode: replay one trace pass into every configuration in the file;
+    //--sweep-mt runs one worker thread per configuration. With --results FILE
+    //each finished configuration is appended to a shared results CSV.
+    if (argc >= 4 && (strcmp(argv[1], "--sweep") == 0 ||
+                      strcmp(argv[1], "--sweep-mt") == 0)) {
+        int threaded = (strcmp(argv[1], "--sweep-mt") == 0);
+        const char *sweep_results = NULL;
+        for (int i = 4; i < argc; i++) {
+            if (strcmp(argv[i], "--results") == 0 && i + 1 < argc) {
+                sweep_results = argv[++i];
+            } else {
+                fprintf(stderr, "Error: Invalid sweep argument %s\n", argv[i]);
+                return 1;
+            }
         }
-    }
-
-    return cache;
-}
-
-//Frees all dynamically allocated memory for a cache
-void free_cache(Cache *cache) {
-    for (int i = 0; i < cache->sets_num; i++) {
-        free(cache->lines[i]);
-    }
-    free(cache->lines);
-    free(cache);
-}
-
-//Computes block id by shifting off block offset bits
-unsigned long get_block_id(Cache *cache, unsigned long address) {
-    return address >> cache->block_bits;
-}
-
-//Computes set index from address using block id and set_bits mask
-unsigned long get_set_index(Cache *cache, unsigned long address) {
-    unsigned long block_id = get_block_id(cache, address);
-    unsigned long mask = (cache->set_bits == 0) ? 0 : ((1UL << cache->set_bits) - 1);
-    return block_id & mask;
-}
-
-//Computes tag by shifting off block offset bits and set index bits
-unsigned long get_tag(Cache *cache, unsigned long address) {
-    return address >> (cache->block_bits + cache->set_bits);
-}
-
-
-//Searches for a matching valid line in the correct set; returns line index or -1 if miss
-int find_line(Cache *cache, unsigned long address, unsigned long *set_idx_out) {
-    unsigned long set_idx = get_set_index(cache, address);
-    unsigned long tag = get_tag(cache, address);
-    *set_idx_out = set_idx;
-
-    for (int i = 0; i < cache->set_lines; i++) {
-        if (cache->lines[set_idx][i].valid &&
-            cache->lines[set_idx][i].tag == tag) {
-            return i;
+        Sweep *sweep = sweep_load(argv[2]);
+        if (!sweep) {
+            return 1;
         }
-    }
-    return -1;
-}
-
-//LRU-mark as most recently used.
-//FIFO-do nothing.
-void update_lru_on_access(Cache *cache, unsigned long set_idx, int line_idx) {
-    //Only update ages for LRU; FIFO ages are handled only on insertion/replacement
-    if (cache->policy != POLICY_LRU) {
-        return;
-    }
-    //For LRU: accessed line age=0, others in same set age++
-    for (int i = 0; i < cache->set_lines; i++) {
-        if (!cache->lines[set_idx][i].valid) continue;
-        if (i == line_idx) {
-            cache->lines[set_idx][i].age = 0;
-        } else {
-            cache->lines[set_idx][i].age++;
+        sweep->results_path = sweep_results;
+        int rc = threaded ? sweep_run_threaded(sweep, argv[3])
+                          : sweep_run(sweep, argv[3]);
+        if (rc != 0) {
+            sweep_free(sweep);
+            return 1;
         }
+        sweep_report(sweep);
+        sweep_free(sweep);
+        return 0;
     }
-}
-
-
-//Loads a block into cache by inserting into an empty line or evicting based on max age
-void load_block(Cache *cache, unsigned long address) {
-    unsigned long set_idx = get_set_index(cache, address);
-    unsigned long tag = get_tag(cache, address);
 
-    int replace_idx = -1;
-    unsigned long max_age = 0;
-
-    //Find an invalid line first; otherwise choose the line with the largest age
-    for (int i = 0; i < cache->set_lines; i++) {
-        if (!cache->lines[set_idx][i].valid) {
-            replace_idx = i;
-            break;
-        }
-        if (cache->lines[set_idx][i].age >= max_age) {
-            max_age = cache->lines[set_idx][i].age;
-            replace_idx = i;
+    //Hierarchy mode: run the trace through an L1/L2/L3 stack from a config file
+    if (argc == 4 && strcmp(argv[1], "--hierarchy") == 0) {
+        Hierarchy *h = hierarchy_load(argv[2]);
+        if (!h) {
+            return 1;
         }
-    }
-
-    //Insert/replace the chosen line
-    cache->lines[set_idx][replace_idx].valid = 1;
-    cache->lines[set_idx][replace_idx].tag = tag;
-
-    //After insertion: new line age=0, others age++ (works for both FIFO+LRU in this implementation)
-    for (int i = 0; i < cache->set_lines; i++) {
-        if (!cache->lines[set_idx][i].valid) continue;
-        if (i == replace_idx) {
-            cache->lines[set_idx][i].age = 0;
-        } else {
-            cache->lines[set_idx][i].age++;
+        if (hierarchy_run(h, argv[3]) != 0) {
+            hierarchy_free(h);
+            return 1;
         }
+        hierarchy_report(h);
+        hierarchy_free(h);
+        return 0;
     }
-}
 
-
-//Prefetches the next sequential block (block_id+1) if not already present
-void prefetch_next(Cache *cache, unsigned long address) {
-    unsigned long block_id = get_block_id(cache, address);
-    unsigned long next_address = (block_id + 1) << cache->block_bits;
-
-    unsigned long set_idx;
-    int line_idx = find_line(cache, next_address, &set_idx);
-
-    //On prefetch miss: count a memory read and load the prefetched block
-    if (line_idx == -1) {
-        cache->reads++;
-        load_block(cache, next_address);
+    //Reuse-distance mode: one trace pass yields the fully-associative LRU
+    //miss-ratio curve across all power-of-two cache sizes
+    if (argc == 4 && strcmp(argv[1], "--reuse") == 0) {
+        return reuse_run(atoi(argv[2]), argv[3]);
     }
-}
 
-//Simulates a read access; on miss loads block and optionally prefetches next
-void simulate_read(Cache *cache, unsigned long address, int prefetch) {
-    unsigned long set_idx;
-    int line_idx = find_line(cache, address, &set_idx);
-
-    if (line_idx != -1) {
-        //Cache hit
-        cache->hits++;
-        update_lru_on_access(cache, set_idx, line_idx);
-    } else {
-        //Cache miss: memory read for demand fetch
-        cache->misses++;
-        cache->reads++;
-        load_block(cache, address);
-        if (prefetch) {
-            prefetch_next(cache, address);
-        }
-    }
-}
-
-//Simulates a write access (write-through, write-allocate style behavior in this code path)
-void simulate_write(Cache *cache, unsigned long address, int prefetch) {
-    unsigned long set_idx;
-    int line_idx = find_line(cache, address, &set_idx);
-
-    if (line_idx != -1) {
-        //Cache hit: count write and update replacement metadata for LRU
-        cache->hits++;
-        cache->writes++;
-        update_lru_on_access(cache, set_idx, line_idx);
-    } else {
-        //Cache miss: fetch block (read), then perform the write; optionally prefetch next
-        cache->misses++;
-        cache->reads++;
-        load_block(cache, address);
-        cache->writes++;
-        if (prefetch) {
-            prefetch_next(cache, address);
+    //Collect positional arguments; optional flags may appear anywhere
+    const char *pos[5];
+    int npos = 0;
+    const char *prefetcher_spec = NULL;
+    int write_back = 0;
+    int parallel = 0;
+    unsigned long warmup = 100000;
+    unsigned long sample_sets = 0;
+    unsigned long interval = 0;
+    const char *checkpoint_path = NULL;
+    unsigned long checkpoint_every = 1000000;
+    const char *resume_path = NULL;
+    int set_stats = 0;
+    const char *index_hash_spec = NULL;
+    int results_format = RESULTS_TEXT;
+    const char *results_path = NULL;
+    const char *tlb_spec = NULL;
+    int victim_entries = 0;
+    int mshr_entries = 0;
+    int mshr_latency = 8;
+    int collapse = 0;
+    int pipeline_mode = 0;
+    int bad_args = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--prefetcher") == 0 && i + 1 < argc) {
+            prefetcher_spec = argv[++i];
+        } else if (strcmp(argv[i], "--write-back") == 0) {
+            write_back = 1;
+        } else if (strcmp(argv[i], "--parallel") == 0 && i + 1 < argc) {
+            parallel = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            warmup = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--sample-sets") == 0 && i + 1 < argc) {
+            sample_sets = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--interval") == 0 && i + 1 < argc) {
+            interval = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+            checkpoint_path = argv[++i];
+        } else if (strcmp(argv[i], "--checkpoint-every") == 0 && i + 1 < argc) {
+            checkpoint_every = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--resume") == 0 && i + 1 < argc) {
+            resume_path = argv[++i];
+        } else if (strcmp(argv[i], "--set-stats") == 0) {
+            set_stats = 1;
+        } else if (strcmp(argv[i], "--index-hash") == 0 && i + 1 < argc) {
+            index_hash_spec = argv[++i];
+        } else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            results_format = parse_results_format(argv[++i]);
+            if (results_format < 0) {
+                fprintf(stderr, "Error: Invalid output format %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--results") == 0 && i + 1 < argc) {
+            results_path = argv[++i];
+        } else if (strcmp(argv[i], "--tlb") == 0 && i + 1 < argc) {
+            tlb_spec = argv[++i];
+        } else if (strcmp(argv[i], "--victim-cache") == 0 && i + 1 < argc) {
+            victim_entries = atoi(argv[++i]);
+            if (victim_entries <= 0) {
+                fprintf(stderr, "Error: Invalid victim cache size %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--mshr") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%d:%d", &mshr_entries, &mshr_latency) < 1 ||
+                mshr_entries <= 0 || mshr_latency <= 0) {
+                fprintf(stderr, "Error: Invalid MSHR spec %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--collapse-repeats") == 0) {
+            collapse = 1;
+        } else if (strcmp(argv[i], "--pipeline") == 0) {
+            pipeline_mode = 1;
+        } else if (npos < 5) {
+            pos[npos++] = argv[i];
+        } else {
+            bad_args = 1;
         }
     }
-}
 
-//Prints the required output stats for one simulation run
-void print_stats(Cache *cache, int prefetch) {
-    printf("Prefetch %d\n", prefetch);
-    printf("Memory reads: %lu\n", cache->reads);
-    printf("Memory writes: %lu\n", cache->writes);
-    printf("Cache hits: %lu\n", cache->hits);
-    printf("Cache misses: %lu\n", cache->misses);
-}
-
-int main(int argc, char *argv[]) {
-    //Expect exactly 5 arguments after program name
-    if (argc != 6) {
+    //Expect exactly 5 positional arguments
+    if (npos != 5 || bad_args) {
         fprintf(stderr,
-                "Usage: %s <cache_size> <associativity> <policy> <block_size> <trace_file>\n",
-                argv[0]);
+                "Usage: %s <cache_size> <associativity> <policy> <block_size> <trace_file>\n"
+                "          [--prefetcher next[:N]|stride[:N]|markov[:N]] [--write-back]\n"
+                "          [--parallel N [--warmup RECORDS]] [--sample-sets N]\n"
+                "          [--interval ACCESSES]\n"
+                "          [--checkpoint FILE [--checkpoint-every RECORDS]] [--resume FILE]\n"
+                "          [--set-stats] [--index-hash mask|xor|skew]\n"
+                "          [--format json|csv] [--results FILE]\n"
+                "          [--tlb ENTRIES[:ASSOC[:PAGE_SIZE]]]\n"
+                "          [--victim-cache ENTRIES] [--mshr ENTRIES[:LATENCY]]\n"
+                "          [--collapse-repeats] [--pipeline]\n"
+                "       %s --convert <text_trace> <binary_trace>\n"
+                "       %s --sweep <config_file> <trace_file> [--results FILE]\n"
+                "       %s --hierarchy <config_file> <trace_file>\n"
+                "       %s --reuse <block_size> <trace_file>\n",
+                argv[0], argv[0], argv[0], argv[0], argv[0]);
         return 1;
     }
 
     //Parse CLI inputs
-    int cache_size = atoi(argv[1]);
-    char *assoc_str = argv[2];
-    char *policy_str = argv[3];
-    int block_size = atoi(argv[4]);
-    char *trace_file = argv[5];
+    int cache_size = atoi(pos[0]);
+    const char *assoc_str = pos[1];
+    const char *policy_str = pos[2];
+    int block_size = atoi(pos[3]);
+    const char *trace_file = pos[4];
 
     //Validate power-of-two requirements
     if (!is_power_of_two(cache_size) || !is_power_of_two(block_size)) {
         fprintf(stderr, "Error: Cache size and block size must be powers of 2\n");
         return 1;
     }
+    if (sample_sets != 0 && !is_power_of_two(sample_sets)) {
+        fprintf(stderr, "Error: Sample-sets factor must be a power of 2\n");
+        return 1;
+    }
 
     //Parse replacement policy
-    int policy;
-    if (strcmp(policy_str, "fifo") == 0) {
-        policy = POLICY_FIFO;
-    } else if (strcmp(policy_str, "lru") == 0) {
-        policy = POLICY_LRU;
-    } else {
+    int policy = parse_policy(policy_str);
+    if (policy < 0) {
         fprintf(stderr, "Error: Invalid replacement policy\n");
         return 1;
     }
 
     //Parse associativity format: direct | assoc | assoc:n
-    int associativity;
-    if (strcmp(assoc_str, "direct") == 0) {
-        associativity = 1;
-    } else if (strcmp(assoc_str, "assoc") == 0) {
-        //one set, all lines in that set
-        associativity = cache_size / block_size;
-    } else if (strncmp(assoc_str, "assoc:", 6) == 0) {
-        associativity = atoi(assoc_str + 6);
-        if (!is_power_of_two(associativity)) {
-            fprintf(stderr, "Error: Associativity must be a power of 2\n");
-            return 1;
-        }
-    } else {
+    int associativity = parse_associativity(assoc_str, cache_size, block_size);
+    if (associativity < 0) {
         fprintf(stderr, "Error: Invalid associativity\n");
         return 1;
     }
 
+    //A sampling factor above the set count leaves only set 0 in the sample
+    //(the extra mask bits select on index bits that do not exist) while the
+    //final scale-up still multiplies by the full factor
+    if (sample_sets > (unsigned long)(cache_size / (associativity * block_size))) {
+        fprintf(stderr, "Error: Sample-sets factor exceeds the number of sets\n");
+        return 1;
+    }
+
+    //Partitioned parallel mode: chunked approximate simulation, clearly
+    //labeled. The partition engine understands only --write-back,
+    //--prefetcher, and --warmup; reject anything else rather than silently
+    //dropping flags that would change the results or the output format.
+    if (parallel > 1) {
+        if (index_hash_spec || sample_sets != 0 || interval != 0 ||
+            checkpoint_path || resume_path || set_stats ||
+            results_format != RESULTS_TEXT || results_path || tlb_spec ||
+            victim_entries > 0 || mshr_entries > 0 || collapse ||
+            pipeline_mode) {
+            fprintf(stderr, "Error: --parallel supports only --write-back, "
+                            "--prefetcher, and --warmup\n");
+            return 1;
+        }
+        return partition_run(cache_size, associativity, block_size, policy,
+                             write_back, prefetcher_spec, trace_file,
+                             parallel, warmup);
+    }
+
     //Run two simulations: no prefetch and with prefetch (same trace)
     Cache *cache_no_prefetch = create_cache(cache_size, associativity, block_size, policy);
     Cache *cache_prefetch    = create_cache(cache_size, associativity, block_size, policy);
 
-    //Open trace file
-    FILE *fp = fopen(trace_file, "r");
-    if (!fp) {
+    //Write-back mode: write hits only dirty the line; memory writes happen on
+    //dirty evictions instead of on every write
+    cache_no_prefetch->write_back = write_back;
+    cache_prefetch->write_back = write_back;
+
+    //Select the set-index function (default mask indexing)
+    if (index_hash_spec) {
+        int index_hash = parse_index_hash(index_hash_spec);
+        if (index_hash < 0) {
+            fprintf(stderr, "Error: Invalid index hash %s\n", index_hash_spec);
+            free_cache(cache_no_prefetch);
+            free_cache(cache_prefetch);
+            return 1;
+        }
+        //Set sampling filters on the decoded set index, which with xor/mask is
+        //where the line actually lives. Skew gives every way its own per-way
+        //index, so the filtered records spray across all sets at reduced
+        //density and the scaled-up counters are biased; refuse the combination.
+        if (index_hash == HASH_SKEW && sample_sets != 0) {
+            fprintf(stderr, "Error: --sample-sets cannot be combined with "
+                            "--index-hash skew\n");
+            free_cache(cache_no_prefetch);
+            free_cache(cache_prefetch);
+            return 1;
+        }
+        cache_set_index_hash(cache_no_prefetch, index_hash);
+        cache_set_index_hash(cache_prefetch, index_hash);
+    }
+
+    //Repeat collapsing is only exact when a prefetch fill can never evict the
+    //block a run just touched. With two or more ways, lru/fifo/plru keep the
+    //touched block off the victim path, so any prefetch fill is harmless.
+    //Direct-mapped, random, and srrip sets CAN victimize it whenever a
+    //prefetched block shares its set — possible with a single set, with
+    //xor/skew indexing (consecutive block ids may collide), or with a
+    //pluggable prefetcher (arbitrary targets) — so refuse those combinations
+    //rather than silently over-counting hits in the prefetch run.
+    if (collapse) {
+        int policy_unsafe = (associativity == 1 || policy == POLICY_RANDOM ||
+                             policy == POLICY_SRRIP);
+        int prefetch_can_collide = (cache_no_prefetch->sets_num == 1 ||
+                                    cache_no_prefetch->index_hash != HASH_MASK ||
+                                    prefetcher_spec != NULL);
+        if (policy_unsafe && prefetch_can_collide) {
+            fprintf(stderr, "Error: --collapse-repeats is not exact for this "
+                            "configuration (a prefetch fill could evict the "
+                            "collapsed block)\n");
+            free_cache(cache_no_prefetch);
+            free_cache(cache_prefetch);
+            return 1;
+        }
+    }
+
+    //Attach the selected prefetcher engine to the prefetching run; without the
+    //flag, demand misses keep the classic next-block prefetch
+    Prefetcher *prefetcher = NULL;
+    if (prefetcher_spec) {
+        prefetcher = parse_prefetcher(prefetcher_spec);
+        if (!prefetcher) {
+            fprintf(stderr, "Error: Invalid prefetcher spec %s\n", prefetcher_spec);
+            free_cache(cache_no_prefetch);
+            free_cache(cache_prefetch);
+            return 1;
+        }
+        cache_prefetch->prefetcher = prefetcher;
+    }
+
+    //Miss-path models: each run gets its own victim buffer and MSHRs so the
+    //prefetch run's extra evictions don't pollute the baseline's. Their state
+    //is not in the snapshot format, so resumed runs would report suffix-only
+    //counters over a cold model; refuse the combination.
+    MissPath *misspath_no_prefetch = NULL;
+    MissPath *misspath_prefetch = NULL;
+    if (victim_entries > 0 || mshr_entries > 0) {
+        if (checkpoint_path || resume_path) {
+            fprintf(stderr, "Error: --victim-cache/--mshr cannot be combined "
+                            "with --checkpoint or --resume\n");
+            free_cache(cache_no_prefetch);
+            free_cache(cache_prefetch);
+            return 1;
+        }
+        misspath_no_prefetch = create_misspath(victim_entries, mshr_entries, mshr_latency);
+        misspath_prefetch = create_misspath(victim_entries, mshr_entries, mshr_latency);
+        cache_set_misspath(cache_no_prefetch, misspath_no_prefetch);
+        cache_set_misspath(cache_prefetch, misspath_prefetch);
+    }
+
+    //TLB co-simulation: a second consumer of the decoded stream, fed from the
+    //no-prefetch decode (prefetch traffic never touches the TLB). TLB state is
+    //not in the snapshot format, so a resumed run's TLB report would cover only
+    //the trace suffix; refuse the combination instead of composing wrong.
+    Tlb *tlb = NULL;
+    if (tlb_spec) {
+        if (checkpoint_path || resume_path) {
+            fprintf(stderr, "Error: --tlb cannot be combined with "
+                            "--checkpoint or --resume\n");
+            free_cache(cache_no_prefetch);
+            free_cache(cache_prefetch);
+            return 1;
+        }
+        tlb = parse_tlb(tlb_spec);
+        if (!tlb) {
+            fprintf(stderr, "Error: Invalid TLB spec %s\n", tlb_spec);
+            free_cache(cache_no_prefetch);
+            free_cache(cache_prefetch);
+            return 1;
+        }
+        if (tlb->page_bits < cache_no_prefetch->block_bits) {
+            fprintf(stderr, "Error: TLB page size must be >= block size\n");
+            free_tlb(tlb);
+            free_cache(cache_no_prefetch);
+            free_cache(cache_prefetch);
+            return 1;
+        }
+    }
+
+    //Open trace file (memory-mapped reader)
+    TraceReader *reader = trace_open(trace_file);
+    if (!reader) {
         fprintf(stderr, "Error: Cannot open trace file %s\n", trace_file);
         free_cache(cache_no_prefetch);
         free_cache(cache_prefetch);
         return 1;
     }
 
-    //Read trace line-by-line; stop at #eof
-    char line[256];
-    while (fgets(line, sizeof(line), fp)) {
-        if (strncmp(line, "#eof", 4) == 0) break;
+    //Resume: restore both caches' state and skip the already-simulated prefix
+    if (resume_path) {
+        unsigned long trace_offset;
+        if (checkpoint_load(resume_path, cache_no_prefetch, cache_prefetch,
+                            &trace_offset) != 0 ||
+            trace_seek(reader, trace_offset) != 0) {
+            trace_close(reader);
+            free_cache(cache_no_prefetch);
+            free_cache(cache_prefetch);
+            return 1;
+        }
+    }
 
-        unsigned long pc, address;
-        char op;
-        //Expected trace format: "<pc>: <R/W> <address>"
-        if (sscanf(line, "%lx: %c %lx", &pc, &op, &address) == 3) {
-            if (op == 'R') {
-                simulate_read(cache_no_prefetch, address, 0);
-                simulate_read(cache_prefetch, address, 1);
-            } else if (op == 'W') {
-                simulate_write(cache_no_prefetch, address, 0);
-                simulate_write(cache_prefetch, address, 1);
-            }
+    //Pipelined ingestion: a reader thread runs ahead of the simulation, so the
+    //trace offset no longer matches the simulated prefix and checkpointing
+    //cannot name a resume point
+    Pipeline *pipeline = NULL;
+    if (pipeline_mode) {
+        if (checkpoint_path || resume_path) {
+            fprintf(stderr, "Error: --pipeline cannot be combined with "
+                            "--checkpoint or --resume\n");
+            trace_close(reader);
+            free_cache(cache_no_prefetch);
+            free_cache(cache_prefetch);
+            return 1;
         }
+        pipeline = pipeline_start(reader);
     }
-    fclose(fp);
 
-    //Print results for both runs
-    print_stats(cache_no_prefetch, 0);
-    print_stats(cache_prefetch, 1);
+    //Stream records into both simulations in large batches. Both caches share
+    //one geometry, so each batch is decoded into (set, tag, block_id) once and
+    //the decoded triples feed both runs, halving per-record decode work.
+    //Pipelined runs simulate straight out of the pipeline's buffers.
+    size_t batch_cap = pipeline_mode ? PIPELINE_BATCH_RECORDS : BATCH_RECORDS;
+    TraceRecord *batch = NULL;
+    if (!pipeline_mode) {
+        batch = (TraceRecord*)malloc(BATCH_RECORDS * sizeof(TraceRecord));
+    }
+    DecodedRecord *decoded = (DecodedRecord*)malloc(batch_cap * sizeof(DecodedRecord));
+    if ((!pipeline_mode && !batch) || !decoded) {
+        fprintf(stderr, "Error: malloc failed\n");
+        exit(1);
+    }
+    //Set sampling: simulate only every sample_sets-th set. Filtering is a mask
+    //test on the decoded set index, done here so the exact-mode simulation path
+    //is completely untouched; surviving records are compacted in place.
+    unsigned long sample_mask = (sample_sets > 1) ? sample_sets - 1 : 0;
+    //Checkpointing: snapshot both caches plus the trace offset every
+    //checkpoint_every records, at batch granularity
+    unsigned long records_since_checkpoint = 0;
+    //Repeat collapsing: a run of consecutive same-block same-op accesses is
+    //simulated as its first two accesses plus a bulk stat increment. For the
+    //configurations admitted by the startup check above, no fill between the
+    //run's kept accesses and its repeats can evict the run's block, so the
+    //repeats are guaranteed hits; the second access is kept so the hit refresh
+    //(LRU MRU-stamp) is applied once, after which further repeats are
+    //idempotent. The prev_* state carries a run across batch boundaries.
+    unsigned long collapse_prev_block = 0;
+    char collapse_prev_op = 0;
+    unsigned long collapse_run_len = 0;
+    unsigned long collapsed_records = 0;
+    //Interval reporting: snapshot rows every 'interval' accesses. Boundaries
+    //are hit exactly by slicing batches; the kernels themselves never check.
+    IntervalStats iv;
+    if (interval > 0) {
+        interval_init(&iv, interval, stdout);
+    }
+    size_t n;
+    TraceRecord *cur_recs;
+    for (;;) {
+        PROBE_BEGIN(PROBE_TRACE_READ);
+        if (pipeline) {
+            n = pipeline_next_batch(pipeline, &cur_recs);
+        } else {
+            cur_recs = batch;
+            n = trace_next_batch(reader, batch, BATCH_RECORDS);
+        }
+        PROBE_END(PROBE_TRACE_READ);
+        if (n == 0) {
+            break;
+        }
+        size_t batch_records = n;
+        PROBE_BEGIN(PROBE_DECODE);
+        decode_batch(cache_no_prefetch, cur_recs, n, decoded);
+        PROBE_END(PROBE_DECODE);
+        //TLB sees every access, before set sampling compacts the batch
+        if (tlb) {
+            tlb_access_batch(tlb, decoded, n, cache_no_prefetch->block_bits);
+        }
+        if (sample_mask) {
+            size_t kept = 0;
+            for (size_t i = 0; i < n; i++) {
+                if ((decoded[i].set_idx & sample_mask) == 0) {
+                    decoded[kept++] = decoded[i];
+                }
+            }
+            n = kept;
+        }
+        if (collapse) {
+            //In the admitted configurations repeats are hits regardless of how
+            //the run's first access fares, so the bulk increments are
+            //state-independent and exact
+            unsigned long extra_hits = 0;
+            unsigned long extra_wt_writes = 0;
+            size_t kept = 0;
+            for (size_t i = 0; i < n; i++) {
+                if (decoded[i].block_id == collapse_prev_block &&
+                    decoded[i].op == collapse_prev_op &&
+                    (decoded[i].op == 'R' || decoded[i].op == 'W')) {
+                    if (++collapse_run_len >= 2) {
+                        extra_hits++;
+                        if (decoded[i].op == 'W' && !write_back) {
+                            extra_wt_writes++;
+                        }
+                        continue;
+                    }
+                } else {
+                    collapse_prev_block = decoded[i].block_id;
+                    collapse_prev_op = decoded[i].op;
+                    collapse_run_len = 0;
+                }
+                decoded[kept++] = decoded[i];
+            }
+            collapsed_records += n - kept;
+            n = kept;
+            cache_no_prefetch->hits += extra_hits;
+            cache_no_prefetch->writes += extra_wt_writes;
+            cache_prefetch->hits += extra_hits;
+            cache_prefetch->writes += extra_wt_writes;
+        }
+        DecodedRecord *cur = decoded;
+        while (n > 0) {
+            size_t chunk = n;
+            if (interval > 0 && iv.countdown < chunk) {
+                chunk = iv.countdown;
+            }
+            simulate_batch_decoded(cache_no_prefetch, cur, chunk, 0);
+            simulate_batch_decoded(cache_prefetch, cur, chunk, 1);
+            if (interval > 0) {
+                iv.accesses += chunk;
+                iv.countdown -= chunk;
+                if (iv.countdown == 0) {
+                    interval_emit(&iv, cache_no_prefetch, cache_prefetch);
+                }
+            }
+            cur += chunk;
+            n -= chunk;
+        }
+        if (checkpoint_path) {
+            records_since_checkpoint += batch_records;
+            if (records_since_checkpoint >= checkpoint_every) {
+                checkpoint_save(checkpoint_path, cache_no_prefetch,
+                                cache_prefetch, trace_tell(reader));
+                records_since_checkpoint = 0;
+            }
+        }
+    }
+    if (pipeline) {
+        pipeline_stop(pipeline);
+    }
+    free(decoded);
+    free(batch);
+    trace_close(reader);
+
+    //Print results for both runs; sampled counters are scaled back up by the
+    //sampling factor and flagged as estimates
+    if (sample_mask) {
+        printf("Sampled result: 1/%lu of sets simulated, stats scaled by %lu "
+               "(approximate)\n", sample_sets, sample_sets);
+        cache_no_prefetch->hits *= sample_sets;
+        cache_no_prefetch->misses *= sample_sets;
+        cache_no_prefetch->reads *= sample_sets;
+        cache_no_prefetch->writes *= sample_sets;
+        cache_prefetch->hits *= sample_sets;
+        cache_prefetch->misses *= sample_sets;
+        cache_prefetch->reads *= sample_sets;
+        cache_prefetch->writes *= sample_sets;
+    }
+    if (collapse) {
+        printf("Collapsed %lu repeat accesses\n", collapsed_records);
+    }
+    if (results_format == RESULTS_TEXT) {
+        print_stats(cache_no_prefetch, 0);
+        print_stats(cache_prefetch, 1);
+    } else {
+        Cache *run_caches[2] = { cache_no_prefetch, cache_prefetch };
+        int run_prefetch[2] = { 0, 1 };
+        results_print(results_format, trace_file, run_caches, run_prefetch, 2);
+    }
+    if (results_path) {
+        results_append(results_path, trace_file, cache_no_prefetch, 0);
+        results_append(results_path, trace_file, cache_prefetch, 1);
+    }
+    if (set_stats) {
+        print_set_stats(cache_no_prefetch, 0, 10);
+        print_set_stats(cache_prefetch, 1, 10);
+    }
+    if (misspath_no_prefetch) {
+        misspath_report(misspath_no_prefetch, 0);
+        misspath_report(misspath_prefetch, 1);
+    }
+    if (tlb) {
+        tlb_report(tlb);
+    }
+    PROBE_REPORT();
 
     //Cleanup
+    if (misspath_no_prefetch) {
+        free_misspath(misspath_no_prefetch);
+        free_misspath(misspath_prefetch);
+    }
+    if (tlb) {
+        free_tlb(tlb);
+    }
+    if (prefetcher) {
+        free_prefetcher(prefetcher);
+    }
     free_cache(cache_no_prefetch);
     free_cache(cache_prefetch);
     return 0;
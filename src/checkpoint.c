@@ -0,0 +1,164 @@
+//Snapshot serialization for resumable runs. The format is host-order binary:
+//an 8-byte magic, one header with the cache geometry and trace offset, then
+//per cache the counters followed by the tags/ages arenas and valid/dirty
+//bitmask words. Saves go through a temp file plus rename so an interrupted
+//save leaves the previous snapshot intact.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "checkpoint.h"
+
+#define CKPT_MAGIC     "CSIMCKP1"
+#define CKPT_MAGIC_LEN 8
+
+//Geometry fields that must match between the snapshot and the resuming run
+typedef struct {
+    unsigned long sets_num;
+    unsigned long set_lines;
+    unsigned long block_size;
+    unsigned long policy;
+    unsigned long write_back;
+    unsigned long index_hash;
+    unsigned long trace_offset;
+} CkptHeader;
+
+//Per-cache scalar state saved alongside the arenas
+typedef struct {
+    unsigned long tick;
+    unsigned long rng;
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long reads;
+    unsigned long writes;
+} CkptCounters;
+
+//Writes one cache's counters and arenas; returns 0 on success
+static int save_cache(FILE *f, const Cache *cache) {
+    CkptCounters c;
+    c.tick = cache->tick;
+    c.rng = cache->rng;
+    c.hits = cache->hits;
+    c.misses = cache->misses;
+    c.reads = cache->reads;
+    c.writes = cache->writes;
+
+    size_t total_lines = (size_t)cache->sets_num * (size_t)cache->set_lines;
+    size_t mask_words = (size_t)cache->sets_num * (size_t)cache->valid_words;
+    if (fwrite(&c, sizeof(c), 1, f) != 1 ||
+        fwrite(cache->tags, sizeof(unsigned long), total_lines, f) != total_lines ||
+        fwrite(cache->ages, sizeof(unsigned long), total_lines, f) != total_lines ||
+        fwrite(cache->valid, sizeof(unsigned long), mask_words, f) != mask_words ||
+        fwrite(cache->dirty, sizeof(unsigned long), mask_words, f) != mask_words ||
+        fwrite(cache->meta, sizeof(unsigned long),
+               (size_t)cache->sets_num, f) != (size_t)cache->sets_num) {
+        return -1;
+    }
+    return 0;
+}
+
+//Reads one cache's counters and arenas; returns 0 on success
+static int load_cache(FILE *f, Cache *cache) {
+    CkptCounters c;
+    size_t total_lines = (size_t)cache->sets_num * (size_t)cache->set_lines;
+    size_t mask_words = (size_t)cache->sets_num * (size_t)cache->valid_words;
+    if (fread(&c, sizeof(c), 1, f) != 1 ||
+        fread(cache->tags, sizeof(unsigned long), total_lines, f) != total_lines ||
+        fread(cache->ages, sizeof(unsigned long), total_lines, f) != total_lines ||
+        fread(cache->valid, sizeof(unsigned long), mask_words, f) != mask_words ||
+        fread(cache->dirty, sizeof(unsigned long), mask_words, f) != mask_words ||
+        fread(cache->meta, sizeof(unsigned long),
+              (size_t)cache->sets_num, f) != (size_t)cache->sets_num) {
+        return -1;
+    }
+    cache->tick = c.tick;
+    cache->rng = c.rng;
+    cache->hits = c.hits;
+    cache->misses = c.misses;
+    cache->reads = c.reads;
+    cache->writes = c.writes;
+    return 0;
+}
+
+int checkpoint_save(const char *path, const Cache *cache_no_prefetch,
+                    const Cache *cache_prefetch, unsigned long trace_offset) {
+    char tmp_path[4096];
+    int n = snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    if (n < 0 || (size_t)n >= sizeof(tmp_path)) {
+        return -1;
+    }
+
+    FILE *f = fopen(tmp_path, "wb");
+    if (!f) {
+        fprintf(stderr, "Error: Cannot create checkpoint file %s\n", tmp_path);
+        return -1;
+    }
+
+    CkptHeader h;
+    h.sets_num = (unsigned long)cache_no_prefetch->sets_num;
+    h.set_lines = (unsigned long)cache_no_prefetch->set_lines;
+    h.block_size = (unsigned long)cache_no_prefetch->block_size;
+    h.policy = (unsigned long)cache_no_prefetch->policy;
+    h.write_back = (unsigned long)cache_no_prefetch->write_back;
+    h.index_hash = (unsigned long)cache_no_prefetch->index_hash;
+    h.trace_offset = trace_offset;
+
+    if (fwrite(CKPT_MAGIC, 1, CKPT_MAGIC_LEN, f) != CKPT_MAGIC_LEN ||
+        fwrite(&h, sizeof(h), 1, f) != 1 ||
+        save_cache(f, cache_no_prefetch) != 0 ||
+        save_cache(f, cache_prefetch) != 0) {
+        fprintf(stderr, "Error: Write failed on %s\n", tmp_path);
+        fclose(f);
+        remove(tmp_path);
+        return -1;
+    }
+    fclose(f);
+
+    if (rename(tmp_path, path) != 0) {
+        fprintf(stderr, "Error: Cannot rename %s to %s\n", tmp_path, path);
+        remove(tmp_path);
+        return -1;
+    }
+    return 0;
+}
+
+int checkpoint_load(const char *path, Cache *cache_no_prefetch,
+                    Cache *cache_prefetch, unsigned long *trace_offset) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "Error: Cannot open checkpoint file %s\n", path);
+        return -1;
+    }
+
+    char magic[CKPT_MAGIC_LEN];
+    CkptHeader h;
+    if (fread(magic, 1, CKPT_MAGIC_LEN, f) != CKPT_MAGIC_LEN ||
+        memcmp(magic, CKPT_MAGIC, CKPT_MAGIC_LEN) != 0 ||
+        fread(&h, sizeof(h), 1, f) != 1) {
+        fprintf(stderr, "Error: %s is not a checkpoint file\n", path);
+        fclose(f);
+        return -1;
+    }
+
+    if (h.sets_num != (unsigned long)cache_no_prefetch->sets_num ||
+        h.set_lines != (unsigned long)cache_no_prefetch->set_lines ||
+        h.block_size != (unsigned long)cache_no_prefetch->block_size ||
+        h.policy != (unsigned long)cache_no_prefetch->policy ||
+        h.write_back != (unsigned long)cache_no_prefetch->write_back ||
+        h.index_hash != (unsigned long)cache_no_prefetch->index_hash) {
+        fprintf(stderr, "Error: Checkpoint %s was taken with a different "
+                        "cache configuration\n", path);
+        fclose(f);
+        return -1;
+    }
+
+    if (load_cache(f, cache_no_prefetch) != 0 ||
+        load_cache(f, cache_prefetch) != 0) {
+        fprintf(stderr, "Error: Checkpoint %s is truncated\n", path);
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+    *trace_offset = h.trace_offset;
+    return 0;
+}
@@ -0,0 +1,26 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "cache.h"
+
+//Checkpoint engine: serializes the full simulator state of the default two-run
+//mode (both caches' line arrays and stats plus the trace byte offset) to a
+//compact snapshot file, and restores it for --resume. Snapshots are written to
+//a temp file and renamed, so a crash mid-save never corrupts the previous one.
+//Prefetcher predictor tables are not serialized; a resumed run's engine starts
+//cold, so with --prefetcher stride or markov it issues different prefetches
+//until the tables rewarm and the prefetch run's counters are not bit-identical
+//to an uninterrupted run. The classic next-block prefetch is stateless and
+//resumes exactly.
+
+//Writes a snapshot of both caches and the trace offset; returns 0 on success
+int checkpoint_save(const char *path, const Cache *cache_no_prefetch,
+                    const Cache *cache_prefetch, unsigned long trace_offset);
+
+//Restores a snapshot into two freshly created caches with the same geometry;
+//fails if the snapshot's configuration does not match. Stores the trace byte
+//offset to seek to. Returns 0 on success.
+int checkpoint_load(const char *path, Cache *cache_no_prefetch,
+                    Cache *cache_prefetch, unsigned long *trace_offset);
+
+#endif
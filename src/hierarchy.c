@@ -0,0 +1,221 @@
+//Multi-level hierarchy engine: chains up to three Cache levels so a miss at
+//one level is looked up in the next. Every record's block id is computed once
+//(all levels share one block size) and the per-level work is the block-level
+//probe-and-fill helpers from cache.c, so a three-level run costs roughly the
+//sum of the per-level probes.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hierarchy.h"
+#include "trace_reader.h"
+
+//Records per reader batch, same as the other simulation modes
+#define HIER_BATCH_RECORDS 4096
+
+Hierarchy* hierarchy_load(const char *config_path) {
+    FILE *fp = fopen(config_path, "r");
+    if (!fp) {
+        fprintf(stderr, "Error: Cannot open config file %s\n", config_path);
+        return NULL;
+    }
+
+    Hierarchy *h = (Hierarchy*)malloc(sizeof(Hierarchy));
+    if (!h) {
+        fprintf(stderr, "Error: malloc failed\n");
+        exit(1);
+    }
+    h->level_count = 0;
+    h->inclusive = 1;
+    h->block_bits = -1;
+
+    char line[256];
+    int line_no = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        line_no++;
+
+        //Skip comments and blank lines
+        char *p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '#' || *p == '\n' || *p == '\0') continue;
+
+        //Inclusion policy lines
+        if (strncmp(p, "inclusive", 9) == 0) {
+            h->inclusive = 1;
+            continue;
+        }
+        if (strncmp(p, "exclusive", 9) == 0) {
+            h->inclusive = 0;
+            continue;
+        }
+
+        //Level lines, L1 first: "<size> <assoc> <policy> <block_size>"
+        int cache_size, block_size;
+        char assoc_str[32], policy_str[8];
+        if (sscanf(p, "%d %31s %7s %d", &cache_size, assoc_str, policy_str,
+                   &block_size) != 4) {
+            fprintf(stderr, "Error: %s:%d: malformed level line\n",
+                    config_path, line_no);
+            goto fail;
+        }
+        if (h->level_count == HIERARCHY_MAX_LEVELS) {
+            fprintf(stderr, "Error: %s:%d: more than %d levels\n",
+                    config_path, line_no, HIERARCHY_MAX_LEVELS);
+            goto fail;
+        }
+        if (!is_power_of_two(cache_size) || !is_power_of_two(block_size)) {
+            fprintf(stderr, "Error: %s:%d: cache size and block size must be powers of 2\n",
+                    config_path, line_no);
+            goto fail;
+        }
+        int policy = parse_policy(policy_str);
+        if (policy < 0) {
+            fprintf(stderr, "Error: %s:%d: invalid replacement policy\n",
+                    config_path, line_no);
+            goto fail;
+        }
+        int associativity = parse_associativity(assoc_str, cache_size, block_size);
+        if (associativity < 0) {
+            fprintf(stderr, "Error: %s:%d: invalid associativity\n",
+                    config_path, line_no);
+            goto fail;
+        }
+
+        //All levels must share one block size so block ids transfer unchanged
+        if (h->block_bits >= 0 && log2_int(block_size) != h->block_bits) {
+            fprintf(stderr, "Error: %s:%d: all levels must use the same block size\n",
+                    config_path, line_no);
+            goto fail;
+        }
+        h->block_bits = log2_int(block_size);
+        h->levels[h->level_count++] =
+            create_cache(cache_size, associativity, block_size, policy);
+    }
+    fclose(fp);
+
+    if (h->level_count == 0) {
+        fprintf(stderr, "Error: %s contains no levels\n", config_path);
+        free(h);
+        return NULL;
+    }
+    return h;
+
+fail:
+    fclose(fp);
+    for (int i = 0; i < h->level_count; i++) {
+        free_cache(h->levels[i]);
+    }
+    free(h);
+    return NULL;
+}
+
+//One access through the level stack. Per level: hits/misses count lookups at
+//that level; reads count requests it forwarded downward (so the last level's
+//reads are the memory reads); writes are counted at L1 (write-through style,
+//matching the single-cache model).
+static void hierarchy_access(Hierarchy *h, unsigned long block_id, int is_write) {
+    Cache *l1 = h->levels[0];
+
+    if (cache_probe_block(l1, block_id, 1)) {
+        l1->hits++;
+        if (is_write) l1->writes++;
+        return;
+    }
+    l1->misses++;
+    l1->reads++;
+    if (is_write) l1->writes++;
+
+    //Walk down the stack until some level has the block
+    int hit_level = -1;
+    for (int i = 1; i < h->level_count; i++) {
+        if (cache_probe_block(h->levels[i], block_id, 1)) {
+            h->levels[i]->hits++;
+            hit_level = i;
+            break;
+        }
+        h->levels[i]->misses++;
+        h->levels[i]->reads++;
+    }
+
+    if (h->inclusive) {
+        //Inclusive: the fetched block is installed at every level that missed,
+        //bottom-up. When a lower level evicts a victim, any copies above it are
+        //back-invalidated, so every block cached at an upper level stays
+        //covered by the levels below it.
+        int fill_to = (hit_level == -1) ? h->level_count - 1 : hit_level - 1;
+        for (int i = fill_to; i >= 0; i--) {
+            unsigned long victim;
+            if (cache_insert_block(h->levels[i], block_id, &victim) && i > 0) {
+                for (int j = 0; j < i; j++) {
+                    cache_invalidate_block(h->levels[j], victim);
+                }
+            }
+        }
+    } else {
+        //Exclusive: the block lives at exactly one level. A lower-level hit
+        //moves it up to L1; fills go to L1 only, and each level's victim is
+        //demoted into the next level down (the last level's victim is dropped).
+        if (hit_level > 0) {
+            cache_invalidate_block(h->levels[hit_level], block_id);
+        }
+        unsigned long b = block_id;
+        for (int i = 0; i < h->level_count; i++) {
+            unsigned long victim;
+            if (!cache_insert_block(h->levels[i], b, &victim)) {
+                break;
+            }
+            b = victim;
+        }
+    }
+}
+
+int hierarchy_run(Hierarchy *h, const char *trace_file) {
+    TraceReader *reader = trace_open(trace_file);
+    if (!reader) {
+        fprintf(stderr, "Error: Cannot open trace file %s\n", trace_file);
+        return 1;
+    }
+
+    TraceRecord *batch = (TraceRecord*)malloc(HIER_BATCH_RECORDS * sizeof(TraceRecord));
+    if (!batch) {
+        fprintf(stderr, "Error: malloc failed\n");
+        exit(1);
+    }
+
+    //Single pass: the block id is computed once per record and shared by all levels
+    size_t n;
+    while ((n = trace_next_batch(reader, batch, HIER_BATCH_RECORDS)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            if (batch[i].op == 'R') {
+                hierarchy_access(h, batch[i].address >> h->block_bits, 0);
+            } else if (batch[i].op == 'W') {
+                hierarchy_access(h, batch[i].address >> h->block_bits, 1);
+            }
+        }
+    }
+    free(batch);
+    trace_close(reader);
+    return 0;
+}
+
+void hierarchy_report(Hierarchy *h) {
+    printf("Hierarchy (%s, %d levels)\n",
+           h->inclusive ? "inclusive" : "exclusive", h->level_count);
+    for (int i = 0; i < h->level_count; i++) {
+        Cache *c = h->levels[i];
+        printf("L%d: size=%d assoc=%d block=%d\n",
+               i + 1, c->sets_num * c->set_lines * c->block_size,
+               c->set_lines, c->block_size);
+        printf("Reads to next level: %lu\n", c->reads);
+        printf("Memory writes: %lu\n", c->writes);
+        printf("Cache hits: %lu\n", c->hits);
+        printf("Cache misses: %lu\n", c->misses);
+    }
+}
+
+void hierarchy_free(Hierarchy *h) {
+    for (int i = 0; i < h->level_count; i++) {
+        free_cache(h->levels[i]);
+    }
+    free(h);
+}
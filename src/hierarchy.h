@@ -0,0 +1,31 @@
+#ifndef HIERARCHY_H
+#define HIERARCHY_H
+
+#include "cache.h"
+
+#define HIERARCHY_MAX_LEVELS 3
+
+//Hierarchy chains up to three Cache levels; a miss at one level flows into the
+//next, and the last level's forwarded reads are the memory reads
+typedef struct {
+    Cache *levels[HIERARCHY_MAX_LEVELS];
+    int level_count;
+    int inclusive;      //1 = fills propagate to every missed level, 0 = exclusive
+    int block_bits;     //shared block geometry for the inter-level block ids
+} Hierarchy;
+
+//Parses a hierarchy configuration file: an optional "inclusive"/"exclusive"
+//line followed by one "<size> <assoc> <policy> <block_size>" line per level,
+//L1 first; returns NULL on failure. All levels must share one block size.
+Hierarchy* hierarchy_load(const char *config_path);
+
+//Replays the trace once through the level stack; returns 0 on success
+int hierarchy_run(Hierarchy *h, const char *trace_file);
+
+//Prints per-level stats, L1 first
+void hierarchy_report(Hierarchy *h);
+
+//Frees all levels and hierarchy state
+void hierarchy_free(Hierarchy *h);
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef INTERVAL_H
+#define INTERVAL_H
+
+#include <stdio.h>
+#include "cache.h"
+
+//Periodic stats snapshots: every 'period' accesses the main loop emits one TSV
+//row per run (prefetch off/on) with the interval's hits/misses/reads/writes and
+//the cumulative totals. Interval deltas come from shadow copies of the previous
+//snapshot, so the simulation hot path is untouched; the main loop only slices
+//batches at interval boundaries.
+typedef struct {
+    unsigned long period;       //accesses between snapshots
+    unsigned long countdown;    //accesses until the next snapshot
+    unsigned long accesses;     //cumulative accesses seen
+    FILE *out;
+    //Shadow counters: totals at the previous snapshot, per run
+    unsigned long prev_hits[2];
+    unsigned long prev_misses[2];
+    unsigned long prev_reads[2];
+    unsigned long prev_writes[2];
+} IntervalStats;
+
+//Initializes the snapshot state and writes the TSV header row
+void interval_init(IntervalStats *iv, unsigned long period, FILE *out);
+
+//Emits one snapshot row per cache and refreshes the shadow counters
+void interval_emit(IntervalStats *iv, const Cache *cache_no_prefetch,
+                   const Cache *cache_prefetch);
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef MISSPATH_H
+#define MISSPATH_H
+
+//Optional miss-path accuracy models, consulted only after a demand miss so the
+//probe hot path never pays for them. The victim cache is a small
+//fully-associative LRU buffer filled from evictions; a demand miss that finds
+//its block there is served without a memory read. MSHRs coalesce repeat misses
+//to a block whose fill is still outstanding, approximated here as the next
+//'latency' misses after allocation.
+
+//MissPath bundles the victim buffer and MSHR state attached to one Cache;
+//either model can be disabled by giving it zero entries
+typedef struct MissPath {
+    //Victim cache: fully associative, LRU; age 0 = invalid
+    int victim_entries;
+    unsigned long *victim_blocks;
+    unsigned long *victim_ages;
+    unsigned long victim_tick;
+    unsigned long victim_hits;
+    //MSHRs: an entry is outstanding until expiry (in demand misses)
+    int mshr_entries;
+    int mshr_latency;
+    unsigned long *mshr_blocks;
+    unsigned long *mshr_expiry;
+    unsigned long miss_count;
+    unsigned long mshr_coalesced;
+} MissPath;
+
+//Allocates the miss-path models; zero entries disables that model
+MissPath* create_misspath(int victim_entries, int mshr_entries, int mshr_latency);
+
+//Called once per demand miss with the missing block; probes the victim buffer
+//and MSHRs and returns 1 if the miss must pay a memory read, 0 if it was
+//absorbed (victim hit or coalesced into an outstanding fill)
+int misspath_memory_read(MissPath *mp, unsigned long block_id);
+
+//Called when the cache displaces a valid block; inserts it into the victim
+//buffer over the LRU slot (a no-op when the victim cache is disabled)
+void misspath_insert_victim(MissPath *mp, unsigned long block_id);
+
+//Prints victim-cache and MSHR counters for one run
+void misspath_report(const MissPath *mp, int prefetch);
+
+//Frees the miss-path state
+void free_misspath(MissPath *mp);
+
+#endif
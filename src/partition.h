@@ -0,0 +1,13 @@
+#ifndef PARTITION_H
+#define PARTITION_H
+
+//Partitioned single-configuration run: splits the trace into nworkers chunks
+//simulated in parallel on private caches, warms each chunk with the preceding
+//warmup records (not counted in stats), and merges the counters. Results are
+//approximate (cold/warm boundaries) and are reported as sampled. prefetcher_spec
+//may be NULL for the classic next-block prefetch. Returns 0 on success.
+int partition_run(int cache_size, int associativity, int block_size, int policy,
+                  int write_back, const char *prefetcher_spec,
+                  const char *trace_file, int nworkers, unsigned long warmup);
+
+#endif
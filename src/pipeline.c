@@ -0,0 +1,95 @@
+//Reader-thread pipeline: classic double buffering over trace_next_batch. The
+//reader thread eats the page faults and refill stalls; the simulation thread
+//only ever blocks when it outruns storage. End of trace is published as a
+//final full buffer with count 0 so the consumer drains in order.
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pipeline.h"
+
+//Reader thread body: fill buffers alternately as the consumer frees them
+static void* pipeline_reader_main(void *arg) {
+    Pipeline *p = (Pipeline*)arg;
+    int fill_idx = 0;
+    for (;;) {
+        PipelineBuf *buf = &p->bufs[fill_idx];
+        pthread_mutex_lock(&p->lock);
+        while (buf->full) {
+            pthread_cond_wait(&p->can_fill, &p->lock);
+        }
+        pthread_mutex_unlock(&p->lock);
+
+        //The buffer is exclusively ours until full is set again
+        size_t n = trace_next_batch(p->reader, buf->recs, PIPELINE_BATCH_RECORDS);
+
+        pthread_mutex_lock(&p->lock);
+        buf->count = n;
+        buf->full = 1;
+        pthread_cond_signal(&p->can_drain);
+        pthread_mutex_unlock(&p->lock);
+
+        if (n == 0) {
+            return NULL;
+        }
+        fill_idx ^= 1;
+    }
+}
+
+Pipeline* pipeline_start(TraceReader *reader) {
+    Pipeline *p = (Pipeline*)malloc(sizeof(Pipeline));
+    if (!p) {
+        fprintf(stderr, "Error: malloc failed\n");
+        exit(1);
+    }
+    p->reader = reader;
+    for (int i = 0; i < 2; i++) {
+        p->bufs[i].count = 0;
+        p->bufs[i].full = 0;
+    }
+    p->drain_idx = 0;
+    p->outstanding = 0;
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->can_fill, NULL);
+    pthread_cond_init(&p->can_drain, NULL);
+    if (pthread_create(&p->thread, NULL, pipeline_reader_main, p) != 0) {
+        fprintf(stderr, "Error: pthread_create failed\n");
+        exit(1);
+    }
+    return p;
+}
+
+size_t pipeline_next_batch(Pipeline *pipeline, TraceRecord **recs_out) {
+    pthread_mutex_lock(&pipeline->lock);
+
+    //Return the drained previous buffer to the reader
+    if (pipeline->outstanding) {
+        pipeline->bufs[pipeline->drain_idx ^ 1].full = 0;
+        pthread_cond_signal(&pipeline->can_fill);
+    }
+
+    PipelineBuf *buf = &pipeline->bufs[pipeline->drain_idx];
+    while (!buf->full) {
+        pthread_cond_wait(&pipeline->can_drain, &pipeline->lock);
+    }
+    pthread_mutex_unlock(&pipeline->lock);
+
+    if (buf->count == 0) {
+        //End of trace: nothing outstanding, the reader thread has exited
+        pipeline->outstanding = 0;
+        return 0;
+    }
+    pipeline->drain_idx ^= 1;
+    pipeline->outstanding = 1;
+    *recs_out = buf->recs;
+    return buf->count;
+}
+
+void pipeline_stop(Pipeline *pipeline) {
+    pthread_join(pipeline->thread, NULL);
+    pthread_mutex_destroy(&pipeline->lock);
+    pthread_cond_destroy(&pipeline->can_fill);
+    pthread_cond_destroy(&pipeline->can_drain);
+    free(pipeline);
+}
@@ -0,0 +1,50 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stddef.h>
+#include <pthread.h>
+
+#include "trace_reader.h"
+
+//Pipelined trace ingestion: a reader thread fills one large record buffer
+//(text, binary, or compressed input all go through trace_next_batch) while
+//the simulation thread drains the other, swapping under a mutex/condvar pair.
+//Overlapping page faults and decompression with simulation hides storage
+//stalls that would otherwise serialize the main loop.
+
+//Records per pipeline buffer: large enough that a cold page fault or refill
+//stall amortizes over many simulated records
+#define PIPELINE_BATCH_RECORDS 65536
+
+//One double-buffer slot; full flags the handoff direction
+typedef struct {
+    TraceRecord recs[PIPELINE_BATCH_RECORDS];
+    size_t count;
+    int full;
+} PipelineBuf;
+
+//Pipeline owns the reader thread and the two buffers; the TraceReader itself
+//is used only by the reader thread once the pipeline starts
+typedef struct {
+    TraceReader *reader;
+    PipelineBuf bufs[2];
+    int drain_idx;          //next buffer the consumer takes
+    int outstanding;        //consumer still holds the previous buffer
+    pthread_mutex_t lock;
+    pthread_cond_t can_fill;
+    pthread_cond_t can_drain;
+    pthread_t thread;
+} Pipeline;
+
+//Spawns the reader thread; the caller must not touch the reader until
+//pipeline_stop() returns
+Pipeline* pipeline_start(TraceReader *reader);
+
+//Hands back the previously returned buffer and blocks until the next one is
+//full; stores its records in *recs_out and returns the count, 0 at end of trace
+size_t pipeline_next_batch(Pipeline *pipeline, TraceRecord **recs_out);
+
+//Joins the reader thread and frees the pipeline (not the TraceReader)
+void pipeline_stop(Pipeline *pipeline);
+
+#endif
@@ -0,0 +1,199 @@
+//Prefetcher framework: pluggable engines triggered on demand misses, all
+//issuing through cache_prefetch_block() so a deep prefetcher pays one probe
+//plus one fill per issued block and nothing more.
+//
+//Engines:
+//  next    - fetch the next N sequential blocks (degree 1 matches the classic
+//            next-block prefetch exactly)
+//  stride  - per-PC stride table; after two misses from the same PC with the
+//            same block delta, fetch block + stride, +2*stride, ... N deep
+//  markov  - first-order miss correlation: remember which blocks followed each
+//            miss block and fetch the remembered successors
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "prefetch.h"
+
+//Predictor table sizes (direct-mapped by hash; powers of two)
+#define STRIDE_TABLE_SIZE   256
+#define MARKOV_TABLE_SIZE   4096
+#define MARKOV_SUCCESSORS   2
+
+//StrideEntry tracks the last miss block and detected stride for one PC
+typedef struct {
+    unsigned long pc;
+    unsigned long last_block;
+    long stride;
+    int confidence;     //consecutive misses confirming the stride
+} StrideEntry;
+
+//MarkovEntry remembers up to MARKOV_SUCCESSORS blocks seen after this block,
+//most recent first
+typedef struct {
+    unsigned long block;
+    unsigned long succ[MARKOV_SUCCESSORS];
+    int succ_count;
+} MarkovEntry;
+
+struct Prefetcher {
+    int kind;
+    int degree;
+    StrideEntry *stride_table;
+    MarkovEntry *markov_table;
+    unsigned long last_miss_block;  //previous miss, for recording transitions
+    int has_last_miss;
+};
+
+Prefetcher* create_prefetcher(int kind, int degree) {
+    Prefetcher *pf = (Prefetcher*)malloc(sizeof(Prefetcher));
+    if (!pf) {
+        fprintf(stderr, "Error: malloc failed\n");
+        exit(1);
+    }
+    pf->kind = kind;
+    pf->degree = (degree < 1) ? 1 : degree;
+    pf->stride_table = NULL;
+    pf->markov_table = NULL;
+    pf->last_miss_block = 0;
+    pf->has_last_miss = 0;
+
+    if (kind == PREFETCH_STRIDE) {
+        pf->stride_table = (StrideEntry*)calloc(STRIDE_TABLE_SIZE, sizeof(StrideEntry));
+        if (!pf->stride_table) {
+            fprintf(stderr, "Error: malloc failed\n");
+            exit(1);
+        }
+    } else if (kind == PREFETCH_MARKOV) {
+        pf->markov_table = (MarkovEntry*)calloc(MARKOV_TABLE_SIZE, sizeof(MarkovEntry));
+        if (!pf->markov_table) {
+            fprintf(stderr, "Error: malloc failed\n");
+            exit(1);
+        }
+    }
+    return pf;
+}
+
+Prefetcher* parse_prefetcher(const char *spec) {
+    //Spec format: <engine>[:<degree>]
+    int kind;
+    size_t name_len;
+    if (strncmp(spec, "next", 4) == 0) {
+        kind = PREFETCH_NEXT;
+        name_len = 4;
+    } else if (strncmp(spec, "stride", 6) == 0) {
+        kind = PREFETCH_STRIDE;
+        name_len = 6;
+    } else if (strncmp(spec, "markov", 6) == 0) {
+        kind = PREFETCH_MARKOV;
+        name_len = 6;
+    } else {
+        return NULL;
+    }
+
+    int degree = 1;
+    if (spec[name_len] == ':') {
+        degree = atoi(spec + name_len + 1);
+        if (degree < 1) {
+            return NULL;
+        }
+    } else if (spec[name_len] != '\0') {
+        return NULL;
+    }
+    return create_prefetcher(kind, degree);
+}
+
+void free_prefetcher(Prefetcher *pf) {
+    free(pf->stride_table);
+    free(pf->markov_table);
+    free(pf);
+}
+
+//Next-N engine: sequential blocks after the miss
+static void prefetch_next_n(Prefetcher *pf, Cache *cache, unsigned long block_id) {
+    for (int d = 1; d <= pf->degree; d++) {
+        cache_prefetch_block(cache, block_id + (unsigned long)d);
+    }
+}
+
+//Stride engine: keyed on the miss PC; issues once the stride repeats
+static void prefetch_stride(Prefetcher *pf, Cache *cache, unsigned long pc,
+                            unsigned long block_id) {
+    StrideEntry *e = &pf->stride_table[pc & (STRIDE_TABLE_SIZE - 1)];
+
+    if (e->pc == pc) {
+        long delta = (long)(block_id - e->last_block);
+        if (delta == e->stride && delta != 0) {
+            if (e->confidence < 2) e->confidence++;
+        } else {
+            e->stride = delta;
+            e->confidence = 0;
+        }
+    } else {
+        //Different PC hashed here: retrain from scratch
+        e->pc = pc;
+        e->stride = 0;
+        e->confidence = 0;
+    }
+    e->last_block = block_id;
+
+    if (e->confidence >= 1 && e->stride != 0) {
+        for (int d = 1; d <= pf->degree; d++) {
+            cache_prefetch_block(cache,
+                    block_id + (unsigned long)(e->stride * (long)d));
+        }
+    }
+}
+
+//Markov engine: record prev-miss -> this-miss, then fetch this block's
+//remembered successors (most recent first, up to degree)
+static void prefetch_markov(Prefetcher *pf, Cache *cache, unsigned long block_id) {
+    if (pf->has_last_miss) {
+        MarkovEntry *prev = &pf->markov_table[pf->last_miss_block & (MARKOV_TABLE_SIZE - 1)];
+        if (prev->block != pf->last_miss_block) {
+            //Table conflict: take over the entry
+            prev->block = pf->last_miss_block;
+            prev->succ_count = 0;
+        }
+        //Insert block_id as most recent successor unless already remembered
+        int known = 0;
+        for (int i = 0; i < prev->succ_count; i++) {
+            if (prev->succ[i] == block_id) {
+                known = 1;
+                break;
+            }
+        }
+        if (!known) {
+            for (int i = MARKOV_SUCCESSORS - 1; i > 0; i--) {
+                prev->succ[i] = prev->succ[i - 1];
+            }
+            prev->succ[0] = block_id;
+            if (prev->succ_count < MARKOV_SUCCESSORS) prev->succ_count++;
+        }
+    }
+    pf->last_miss_block = block_id;
+    pf->has_last_miss = 1;
+
+    MarkovEntry *e = &pf->markov_table[block_id & (MARKOV_TABLE_SIZE - 1)];
+    if (e->block == block_id) {
+        int issue = (e->succ_count < pf->degree) ? e->succ_count : pf->degree;
+        for (int i = 0; i < issue; i++) {
+            cache_prefetch_block(cache, e->succ[i]);
+        }
+    }
+}
+
+void prefetcher_on_miss(Prefetcher *pf, Cache *cache, unsigned long pc,
+                        unsigned long block_id) {
+    switch (pf->kind) {
+        case PREFETCH_NEXT:
+            prefetch_next_n(pf, cache, block_id);
+            break;
+        case PREFETCH_STRIDE:
+            prefetch_stride(pf, cache, pc, block_id);
+            break;
+        case PREFETCH_MARKOV:
+            prefetch_markov(pf, cache, block_id);
+            break;
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include "cache.h"
+
+//Prefetcher engine identifiers
+enum {
+    PREFETCH_NEXT   = 0,    //next-N sequential blocks
+    PREFETCH_STRIDE = 1,    //per-PC stride detection
+    PREFETCH_MARKOV = 2     //miss-correlation (Markov) table
+};
+
+//Opaque prefetcher handle; holds the engine kind, degree, and predictor tables
+typedef struct Prefetcher Prefetcher;
+
+//Allocates a prefetcher of the given kind with the given degree (blocks issued
+//per triggering miss)
+Prefetcher* create_prefetcher(int kind, int degree);
+
+//Parses a CLI spec ("next", "stride:4", "markov:2", ...); returns NULL if invalid
+Prefetcher* parse_prefetcher(const char *spec);
+
+//Frees all prefetcher state
+void free_prefetcher(Prefetcher *pf);
+
+//Called on every demand miss with the access pc and missing block id; updates
+//the engine's predictor state and issues prefetches via cache_prefetch_block()
+void prefetcher_on_miss(Prefetcher *pf, Cache *cache, unsigned long pc,
+                        unsigned long block_id);
+
+#endif
@@ -0,0 +1,31 @@
+//Per-stage cycle accounting for profiled builds (-DCACHESIM_PROFILE). The
+//counters and report live here unconditionally; whether anything increments
+//them is decided by the PROBE_* macros in probe.h.
+#include <stdio.h>
+
+#include "probe.h"
+
+unsigned long long probe_cycles[PROBE_STAGE_COUNT];
+unsigned long long probe_calls[PROBE_STAGE_COUNT];
+
+static const char *probe_stage_names[PROBE_STAGE_COUNT] = {
+    "trace_read",
+    "decode",
+    "probe",
+    "lru_update",
+    "fill_evict",
+    "prefetch",
+};
+
+void probe_report(void) {
+    printf("Stage cycle profile\n");
+    printf("%-12s %16s %14s %12s\n", "stage", "cycles", "calls", "cycles/call");
+    for (int s = 0; s < PROBE_STAGE_COUNT; s++) {
+        if (probe_calls[s] == 0) {
+            continue;
+        }
+        printf("%-12s %16llu %14llu %12.1f\n",
+               probe_stage_names[s], probe_cycles[s], probe_calls[s],
+               (double)probe_cycles[s] / (double)probe_calls[s]);
+    }
+}
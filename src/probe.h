@@ -0,0 +1,59 @@
+#ifndef PROBE_H
+#define PROBE_H
+
+//Compile-time-optional hot-path instrumentation. Build with -DCACHESIM_PROFILE
+//(make PROFILE=1) to wrap each simulation stage in rdtsc probes that accumulate
+//per-stage cycle totals and call counts, reported after the normal stats.
+//Without the flag every macro expands to nothing, so the production build pays
+//zero overhead. Profiled builds run the generic access path (the specialized
+//batch kernels inline their stages and would defeat per-stage attribution).
+
+//One counter slot per hot stage
+enum {
+    PROBE_TRACE_READ,   //trace_next_batch: mmap scan / record unpack
+    PROBE_DECODE,       //decode_batch: address -> (set, tag, block id)
+    PROBE_PROBE,        //probe_set: tag search
+    PROBE_LRU,          //update_lru_on_access: recency stamp
+    PROBE_FILL,         //fill_set_line_evict: victim scan + insert
+    PROBE_PREFETCH,     //cache_prefetch_block: prefetch probe + fill
+    PROBE_STAGE_COUNT
+};
+
+#ifdef CACHESIM_PROFILE
+
+extern unsigned long long probe_cycles[PROBE_STAGE_COUNT];
+extern unsigned long long probe_calls[PROBE_STAGE_COUNT];
+
+//Timestamp source: rdtsc on x86, clock() ticks elsewhere (units differ but
+//per-stage ratios remain meaningful)
+#if defined(__x86_64__) || defined(__i386__)
+static inline unsigned long long probe_now(void) {
+    unsigned int lo, hi;
+    __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((unsigned long long)hi << 32) | lo;
+}
+#else
+#include <time.h>
+static inline unsigned long long probe_now(void) {
+    return (unsigned long long)clock();
+}
+#endif
+
+#define PROBE_BEGIN(stage) unsigned long long probe_t0_##stage = probe_now()
+#define PROBE_END(stage) \
+    (probe_cycles[stage] += probe_now() - probe_t0_##stage, probe_calls[stage]++)
+#define PROBE_REPORT() probe_report()
+
+#else
+
+#define PROBE_BEGIN(stage)
+#define PROBE_END(stage)
+#define PROBE_REPORT()
+
+#endif
+
+//Prints per-stage cycle totals, call counts, and cycles/call for every stage
+//that fired (no-op data in non-profile builds, where nothing fires)
+void probe_report(void);
+
+#endif
@@ -0,0 +1,127 @@
+//Structured results subsystem. Every run is described by the same column set
+//(configuration plus counters); results_print renders runs as JSON or CSV on
+//stdout for single-run scripting, and results_append serializes one CSV row
+//into a shared append-only file. The append is a single write() holding an
+//exclusive flock, so rows from concurrent sweep processes never interleave
+//and a farm can stream results from thousands of runs into one file.
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+
+#include "results.h"
+
+#define RESULTS_HEADER \
+    "trace,cache_size,associativity,block_size,policy,index_hash," \
+    "write_back,prefetch,reads,writes,hits,misses\n"
+
+static const char* policy_name(int policy) {
+    switch (policy) {
+        case POLICY_FIFO:   return "fifo";
+        case POLICY_LRU:    return "lru";
+        case POLICY_PLRU:   return "plru";
+        case POLICY_SRRIP:  return "srrip";
+        case POLICY_RANDOM: return "random";
+    }
+    return "unknown";
+}
+
+static const char* hash_name(int index_hash) {
+    switch (index_hash) {
+        case HASH_MASK: return "mask";
+        case HASH_XOR:  return "xor";
+        case HASH_SKEW: return "skew";
+    }
+    return "unknown";
+}
+
+//Total capacity in bytes, recovered from the geometry
+static long cache_total_size(const Cache *cache) {
+    return (long)cache->sets_num * cache->set_lines * cache->block_size;
+}
+
+//Renders one run as a CSV row; returns the row length
+static int format_row(char *buf, size_t cap, const char *trace_file,
+                      const Cache *cache, int prefetch) {
+    return snprintf(buf, cap, "%s,%ld,%d,%d,%s,%s,%d,%d,%lu,%lu,%lu,%lu\n",
+                    trace_file, cache_total_size(cache), cache->set_lines,
+                    cache->block_size, policy_name(cache->policy),
+                    hash_name(cache->index_hash), cache->write_back, prefetch,
+                    cache->reads, cache->writes, cache->hits, cache->misses);
+}
+
+int parse_results_format(const char *format_str) {
+    if (strcmp(format_str, "json") == 0) return RESULTS_JSON;
+    if (strcmp(format_str, "csv") == 0) return RESULTS_CSV;
+    return -1;
+}
+
+void results_print(int format, const char *trace_file, Cache *const *caches,
+                   const int *prefetch, int count) {
+    if (format == RESULTS_CSV) {
+        fputs(RESULTS_HEADER, stdout);
+        char row[512];
+        for (int i = 0; i < count; i++) {
+            format_row(row, sizeof(row), trace_file, caches[i], prefetch[i]);
+            fputs(row, stdout);
+        }
+        return;
+    }
+
+    printf("{\n  \"trace\": \"%s\",\n  \"runs\": [\n", trace_file);
+    for (int i = 0; i < count; i++) {
+        const Cache *c = caches[i];
+        printf("    {\"cache_size\": %ld, \"associativity\": %d, "
+               "\"block_size\": %d, \"policy\": \"%s\", \"index_hash\": \"%s\", "
+               "\"write_back\": %d, \"prefetch\": %d, "
+               "\"reads\": %lu, \"writes\": %lu, \"hits\": %lu, \"misses\": %lu}%s\n",
+               cache_total_size(c), c->set_lines, c->block_size,
+               policy_name(c->policy), hash_name(c->index_hash),
+               c->write_back, prefetch[i],
+               c->reads, c->writes, c->hits, c->misses,
+               (i + 1 < count) ? "," : "");
+    }
+    printf("  ]\n}\n");
+}
+
+int results_append(const char *path, const char *trace_file, const Cache *cache,
+                   int prefetch) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot open results file %s\n", path);
+        return -1;
+    }
+    if (flock(fd, LOCK_EX) != 0) {
+        fprintf(stderr, "Error: Cannot lock results file %s\n", path);
+        close(fd);
+        return -1;
+    }
+
+    //First writer into an empty file emits the header under the same lock
+    struct stat st;
+    int rc = 0;
+    if (fstat(fd, &st) == 0 && st.st_size == 0) {
+        if (write(fd, RESULTS_HEADER, strlen(RESULTS_HEADER)) < 0) {
+            rc = -1;
+        }
+    }
+
+    char row[512];
+    int len = format_row(row, sizeof(row), trace_file, cache, prefetch);
+    if (rc == 0 && (len < 0 || write(fd, row, (size_t)len) != (ssize_t)len)) {
+        rc = -1;
+    }
+    if (rc != 0) {
+        fprintf(stderr, "Error: Write failed on %s\n", path);
+    }
+
+    flock(fd, LOCK_UN);
+    close(fd);
+    return rc;
+}
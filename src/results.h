@@ -0,0 +1,32 @@
+#ifndef RESULTS_H
+#define RESULTS_H
+
+#include "cache.h"
+
+//Structured results emission for sweep farms: machine-readable counters keyed
+//by configuration, either printed to stdout (--format json|csv) or appended
+//as one CSV row per finished run to a shared results file (--results FILE).
+//Appends are a single write under an exclusive flock, so thousands of
+//concurrent runs can share one file without a collector process.
+
+//Output formats for results_print; TEXT means the classic print_stats lines
+enum {
+    RESULTS_TEXT = 0,
+    RESULTS_JSON = 1,
+    RESULTS_CSV  = 2
+};
+
+//Parses a format string (json/csv); returns the format id or -1 if invalid
+int parse_results_format(const char *format_str);
+
+//Prints count runs to stdout in the given format; each run pairs caches[i]
+//with its prefetch[i] flag and carries its full configuration
+void results_print(int format, const char *trace_file, Cache *const *caches,
+                   const int *prefetch, int count);
+
+//Appends one run's CSV row to the shared results file (creating it with a
+//header row if empty); returns 0 on success
+int results_append(const char *path, const char *trace_file, const Cache *cache,
+                   int prefetch);
+
+#endif
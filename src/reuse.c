@@ -0,0 +1,269 @@
+//Reuse-distance profiler: Mattson's stack algorithm. The LRU stack is kept as
+//an order-statistic treap keyed by last-access time (subtree sizes give the
+//stack depth of any block in O(log n)), and a hash table maps block id to its
+//last-access time. One O(n log n) pass yields the miss count of every
+//fully-associative LRU capacity at once: an access with stack distance d
+//misses in any cache of fewer than d+1 blocks. Distances are binned into
+//power-of-two buckets, which is exact for the power-of-two capacities the
+//report prints.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "reuse.h"
+#include "cache.h"
+#include "trace_reader.h"
+
+//Distance buckets: bucket 0 holds distance 0, bucket k holds [2^(k-1), 2^k),
+//so every power-of-two capacity boundary falls exactly between two buckets
+#define REUSE_BUCKETS 42
+
+//Treap node: BST by last-access time, heap by random priority, with subtree sizes
+typedef struct RNode {
+    unsigned long time;
+    unsigned int priority;
+    size_t size;
+    struct RNode *left;
+    struct RNode *right;
+} RNode;
+
+static size_t rnode_size(const RNode *n) {
+    return n ? n->size : 0;
+}
+
+static void rnode_update(RNode *n) {
+    n->size = 1 + rnode_size(n->left) + rnode_size(n->right);
+}
+
+//xorshift PRNG for treap priorities (no libc rand state needed)
+static unsigned int rnode_rand(void) {
+    static unsigned int state = 0x9e3779b9u;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+//Joins two treaps where every time in l is less than every time in r
+static RNode* rnode_merge(RNode *l, RNode *r) {
+    if (!l) return r;
+    if (!r) return l;
+    if (l->priority > r->priority) {
+        l->right = rnode_merge(l->right, r);
+        rnode_update(l);
+        return l;
+    } else {
+        r->left = rnode_merge(l, r->left);
+        rnode_update(r);
+        return r;
+    }
+}
+
+//Inserts a node whose time exceeds every time already in the treap (times are
+//a monotonically increasing access counter), so insertion is a plain merge
+static RNode* rnode_insert(RNode *root, RNode *node) {
+    return rnode_merge(root, node);
+}
+
+//Removes the node with the given time; the caller owns the removed node
+static RNode* rnode_delete(RNode *root, unsigned long time, RNode **removed) {
+    if (!root) {
+        return NULL;
+    }
+    if (time == root->time) {
+        *removed = root;
+        RNode *rest = rnode_merge(root->left, root->right);
+        root->left = root->right = NULL;
+        return rest;
+    }
+    if (time < root->time) {
+        root->left = rnode_delete(root->left, time, removed);
+    } else {
+        root->right = rnode_delete(root->right, time, removed);
+    }
+    rnode_update(root);
+    return root;
+}
+
+//Frees a whole treap
+static void rnode_free(RNode *root) {
+    if (!root) return;
+    rnode_free(root->left);
+    rnode_free(root->right);
+    free(root);
+}
+
+//Counts nodes with time greater than t (blocks touched more recently)
+static size_t rnode_rank_above(const RNode *root, unsigned long t) {
+    size_t rank = 0;
+    while (root) {
+        if (t < root->time) {
+            rank += 1 + rnode_size(root->right);
+            root = root->left;
+        } else {
+            root = root->right;
+        }
+    }
+    return rank;
+}
+
+//Open-addressing hash table: block id -> last-access time
+typedef struct {
+    unsigned long block;
+    unsigned long time;     //0 = empty slot (times start at 1)
+} BlockSlot;
+
+typedef struct {
+    BlockSlot *slots;
+    size_t cap;             //power of two
+    size_t used;
+} BlockMap;
+
+static void blockmap_init(BlockMap *map) {
+    map->cap = 1 << 16;
+    map->used = 0;
+    map->slots = (BlockSlot*)calloc(map->cap, sizeof(BlockSlot));
+    if (!map->slots) {
+        fprintf(stderr, "Error: malloc failed\n");
+        exit(1);
+    }
+}
+
+static unsigned long block_hash(unsigned long block) {
+    //Fibonacci hashing spreads sequential block ids across the table
+    return block * 0x9e3779b97f4a7c15UL;
+}
+
+static BlockSlot* blockmap_find(BlockMap *map, unsigned long block) {
+    size_t mask = map->cap - 1;
+    size_t i = block_hash(block) & mask;
+    while (map->slots[i].time != 0) {
+        if (map->slots[i].block == block) {
+            return &map->slots[i];
+        }
+        i = (i + 1) & mask;
+    }
+    return &map->slots[i];    //empty slot where this block would go
+}
+
+static void blockmap_grow(BlockMap *map) {
+    size_t old_cap = map->cap;
+    BlockSlot *old = map->slots;
+    map->cap *= 2;
+    map->slots = (BlockSlot*)calloc(map->cap, sizeof(BlockSlot));
+    if (!map->slots) {
+        fprintf(stderr, "Error: malloc failed\n");
+        exit(1);
+    }
+    for (size_t i = 0; i < old_cap; i++) {
+        if (old[i].time != 0) {
+            BlockSlot *s = blockmap_find(map, old[i].block);
+            *s = old[i];
+        }
+    }
+    free(old);
+}
+
+//Maps a stack distance to its bucket: 0 for d == 0, floor(log2(d)) + 1 otherwise
+static int reuse_bucket(size_t d) {
+    int k = 0;
+    while (d != 0 && k < REUSE_BUCKETS - 1) {
+        d >>= 1;
+        k++;
+    }
+    return k;
+}
+
+int reuse_run(int block_size, const char *trace_file) {
+    if (!is_power_of_two(block_size)) {
+        fprintf(stderr, "Error: Cache size and block size must be powers of 2\n");
+        return 1;
+    }
+    int block_bits = log2_int(block_size);
+
+    TraceReader *reader = trace_open(trace_file);
+    if (!reader) {
+        fprintf(stderr, "Error: Cannot open trace file %s\n", trace_file);
+        return 1;
+    }
+
+    BlockMap map;
+    blockmap_init(&map);
+    RNode *stack = NULL;
+
+    unsigned long hist[REUSE_BUCKETS] = {0};
+    unsigned long total = 0;
+    unsigned long cold = 0;
+    unsigned long now = 0;
+
+    TraceRecord rec;
+    while (trace_next(reader, &rec)) {
+        if (rec.op != 'R' && rec.op != 'W') continue;
+        unsigned long block = rec.address >> block_bits;
+        total++;
+        now++;
+
+        BlockSlot *slot = blockmap_find(&map, block);
+        RNode *node;
+        if (slot->time != 0) {
+            //Reuse: stack distance is the number of distinct blocks accessed
+            //since the previous touch of this block
+            size_t d = rnode_rank_above(stack, slot->time);
+            hist[reuse_bucket(d)]++;
+            RNode *removed = NULL;
+            stack = rnode_delete(stack, slot->time, &removed);
+            node = removed;
+        } else {
+            //First touch: compulsory miss at every capacity
+            cold++;
+            map.used++;
+            if (map.used * 2 > map.cap) {
+                blockmap_grow(&map);
+                slot = blockmap_find(&map, block);
+            }
+            slot->block = block;
+            node = (RNode*)malloc(sizeof(RNode));
+            if (!node) {
+                fprintf(stderr, "Error: malloc failed\n");
+                exit(1);
+            }
+        }
+        slot->time = now;
+        node->time = now;
+        node->priority = rnode_rand();
+        node->left = node->right = NULL;
+        node->size = 1;
+        stack = rnode_insert(stack, node);
+    }
+    trace_close(reader);
+
+    //Report: a reuse at stack distance d hits a capacity-C LRU cache iff d < C,
+    //so misses at capacity 2^k = cold + all reuses in buckets k+1 and above
+    //(bucket k+1 starts exactly at distance 2^k)
+    unsigned long distinct = map.used;
+    printf("Reuse-distance profile (fully-associative LRU, block size %d)\n",
+           block_size);
+    printf("Total accesses: %lu\n", total);
+    printf("Distinct blocks: %lu\n", distinct);
+    printf("Cold misses: %lu\n", cold);
+    printf("Cache size\tMiss ratio\n");
+
+    //Stop once the capacity covers every distinct block (miss ratio has
+    //bottomed out at the cold-miss floor)
+    for (int k = 0; k < REUSE_BUCKETS - 1; k++) {
+        unsigned long capacity = 1UL << k;
+        unsigned long misses = cold;
+        for (int j = k + 1; j < REUSE_BUCKETS; j++) {
+            misses += hist[j];
+        }
+        printf("%lu\t%.6f\n", capacity * (unsigned long)block_size,
+               total ? (double)misses / (double)total : 0.0);
+        if (capacity >= distinct) {
+            break;
+        }
+    }
+
+    rnode_free(stack);
+    free(map.slots);
+    return 0;
+}
@@ -0,0 +1,11 @@
+#ifndef REUSE_H
+#define REUSE_H
+
+//Reuse-distance (stack-distance) profiler: one pass over the trace computes
+//the miss ratio of a fully-associative LRU cache at every power-of-two
+//capacity simultaneously (Mattson's stack algorithm over block ids).
+//Runs the analysis for the given block size and prints the miss-ratio curve;
+//returns 0 on success.
+int reuse_run(int block_size, const char *trace_file);
+
+#endif
@@ -0,0 +1,377 @@
+//Sweep engine: replays one pass over the trace into many cache configurations,
+//amortizing all I/O and parse cost across the whole design-space study instead
+//of re-reading the file once per configuration.
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "sweep.h"
+#include "trace_reader.h"
+#include "results.h"
+
+//Initial capacity for the config list; grows by doubling
+#define SWEEP_INITIAL_CAP 8
+
+//Records per published batch and number of reusable batch buffers; batches are
+//large so per-batch synchronization cost is amortized over thousands of records
+#define SWEEP_BATCH_RECORDS 4096
+#define SWEEP_BATCH_POOL    8
+
+Sweep* sweep_load(const char *config_path) {
+    FILE *fp = fopen(config_path, "r");
+    if (!fp) {
+        fprintf(stderr, "Error: Cannot open config file %s\n", config_path);
+        return NULL;
+    }
+
+    Sweep *sweep = (Sweep*)malloc(sizeof(Sweep));
+    if (!sweep) {
+        fprintf(stderr, "Error: malloc failed\n");
+        exit(1);
+    }
+    int cap = SWEEP_INITIAL_CAP;
+    sweep->configs = (SweepConfig*)malloc(cap * sizeof(SweepConfig));
+    if (!sweep->configs) {
+        fprintf(stderr, "Error: malloc failed\n");
+        exit(1);
+    }
+    sweep->count = 0;
+    sweep->results_path = NULL;
+
+    //One configuration per line: "<cache_size> <assoc> <policy> <block_size> [prefetch]"
+    char line[256];
+    int line_no = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        line_no++;
+
+        //Skip comments and blank lines
+        char *p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '#' || *p == '\n' || *p == '\0') continue;
+
+        int cache_size, block_size, prefetch = 0;
+        char assoc_str[32], policy_str[8];
+        int fields = sscanf(p, "%d %31s %7s %d %d",
+                            &cache_size, assoc_str, policy_str, &block_size, &prefetch);
+        if (fields < 4) {
+            fprintf(stderr, "Error: %s:%d: malformed configuration line\n",
+                    config_path, line_no);
+            goto fail;
+        }
+
+        //Validate exactly like the CLI path in main()
+        if (!is_power_of_two(cache_size) || !is_power_of_two(block_size)) {
+            fprintf(stderr, "Error: %s:%d: cache size and block size must be powers of 2\n",
+                    config_path, line_no);
+            goto fail;
+        }
+        int policy = parse_policy(policy_str);
+        if (policy < 0) {
+            fprintf(stderr, "Error: %s:%d: invalid replacement policy\n",
+                    config_path, line_no);
+            goto fail;
+        }
+        int associativity = parse_associativity(assoc_str, cache_size, block_size);
+        if (associativity < 0) {
+            fprintf(stderr, "Error: %s:%d: invalid associativity\n",
+                    config_path, line_no);
+            goto fail;
+        }
+
+        if (sweep->count == cap) {
+            cap *= 2;
+            sweep->configs = (SweepConfig*)realloc(sweep->configs,
+                                                   cap * sizeof(SweepConfig));
+            if (!sweep->configs) {
+                fprintf(stderr, "Error: malloc failed\n");
+                exit(1);
+            }
+        }
+
+        SweepConfig *cfg = &sweep->configs[sweep->count++];
+        cfg->cache_size = cache_size;
+        cfg->associativity = associativity;
+        cfg->block_size = block_size;
+        cfg->policy = policy;
+        cfg->prefetch = (prefetch != 0);
+        strcpy(cfg->assoc_str, assoc_str);
+        strcpy(cfg->policy_str, policy_str);
+        cfg->cache = create_cache(cache_size, associativity, block_size, policy);
+    }
+    fclose(fp);
+
+    if (sweep->count == 0) {
+        fprintf(stderr, "Error: %s contains no configurations\n", config_path);
+        free(sweep->configs);
+        free(sweep);
+        return NULL;
+    }
+    return sweep;
+
+fail:
+    fclose(fp);
+    for (int i = 0; i < sweep->count; i++) {
+        free_cache(sweep->configs[i].cache);
+    }
+    free(sweep->configs);
+    free(sweep);
+    return NULL;
+}
+
+int sweep_run(Sweep *sweep, const char *trace_file) {
+    TraceReader *reader = trace_open(trace_file);
+    if (!reader) {
+        fprintf(stderr, "Error: Cannot open trace file %s\n", trace_file);
+        return 1;
+    }
+
+    //Group configurations by decode geometry (block_bits, set_bits): members of
+    //a group see identical (set, tag, block_id) triples, so each batch is
+    //decoded once per group instead of once per configuration. group[i] holds
+    //the index of the first earlier config with the same geometry, or i itself.
+    int *group = (int*)malloc(sweep->count * sizeof(int));
+    TraceRecord *batch = (TraceRecord*)malloc(SWEEP_BATCH_RECORDS * sizeof(TraceRecord));
+    DecodedRecord *decoded = (DecodedRecord*)malloc(SWEEP_BATCH_RECORDS * sizeof(DecodedRecord));
+    if (!group || !batch || !decoded) {
+        fprintf(stderr, "Error: malloc failed\n");
+        exit(1);
+    }
+    for (int i = 0; i < sweep->count; i++) {
+        group[i] = i;
+        for (int j = 0; j < i; j++) {
+            if (sweep->configs[j].cache->block_bits == sweep->configs[i].cache->block_bits &&
+                sweep->configs[j].cache->set_bits == sweep->configs[i].cache->set_bits) {
+                group[i] = group[j];
+                break;
+            }
+        }
+    }
+
+    //Single pass: every batch is decoded once per geometry group, then fed to
+    //each configuration one at a time so its cache stays hot for the whole batch
+    size_t n;
+    while ((n = trace_next_batch(reader, batch, SWEEP_BATCH_RECORDS)) > 0) {
+        for (int g = 0; g < sweep->count; g++) {
+            if (group[g] != g) continue;    //not a group leader
+            decode_batch(sweep->configs[g].cache, batch, n, decoded);
+            for (int i = g; i < sweep->count; i++) {
+                if (group[i] != g) continue;
+                simulate_batch_decoded(sweep->configs[i].cache, decoded, n,
+                                       sweep->configs[i].prefetch);
+            }
+        }
+    }
+    free(decoded);
+    free(batch);
+    free(group);
+    trace_close(reader);
+
+    //Stream finished configurations into the shared results file
+    if (sweep->results_path) {
+        for (int i = 0; i < sweep->count; i++) {
+            results_append(sweep->results_path, trace_file,
+                           sweep->configs[i].cache, sweep->configs[i].prefetch);
+        }
+    }
+    return 0;
+}
+
+//SweepBatch is one block of decoded records, shared read-only by all workers;
+//pending counts workers that still have to drain it before the producer may refill
+typedef struct {
+    TraceRecord recs[SWEEP_BATCH_RECORDS];
+    int count;
+    int pending;
+    pthread_mutex_t lock;
+    pthread_cond_t drained;
+} SweepBatch;
+
+//Single-producer single-consumer queue of batch pointers feeding one worker
+typedef struct {
+    SweepBatch *slots[SWEEP_BATCH_POOL];
+    int head;
+    int tail;
+    int count;
+    int done;   //producer reached end of trace
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+} SweepQueue;
+
+//SweepWorker simulates one configuration on its own thread; all mutable state
+//(the Cache and its stats) is private to the worker, so no hot-path locking
+typedef struct {
+    SweepConfig *cfg;
+    SweepQueue queue;
+    pthread_t thread;
+} SweepWorker;
+
+static void queue_init(SweepQueue *q) {
+    q->head = q->tail = q->count = 0;
+    q->done = 0;
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->not_empty, NULL);
+    pthread_cond_init(&q->not_full, NULL);
+}
+
+static void queue_push(SweepQueue *q, SweepBatch *batch) {
+    pthread_mutex_lock(&q->lock);
+    while (q->count == SWEEP_BATCH_POOL) {
+        pthread_cond_wait(&q->not_full, &q->lock);
+    }
+    q->slots[q->tail] = batch;
+    q->tail = (q->tail + 1) % SWEEP_BATCH_POOL;
+    q->count++;
+    pthread_cond_signal(&q->not_empty);
+    pthread_mutex_unlock(&q->lock);
+}
+
+//Pops the next batch, or returns NULL once the producer is done and the queue drained
+static SweepBatch* queue_pop(SweepQueue *q) {
+    pthread_mutex_lock(&q->lock);
+    while (q->count == 0 && !q->done) {
+        pthread_cond_wait(&q->not_empty, &q->lock);
+    }
+    if (q->count == 0) {
+        pthread_mutex_unlock(&q->lock);
+        return NULL;
+    }
+    SweepBatch *batch = q->slots[q->head];
+    q->head = (q->head + 1) % SWEEP_BATCH_POOL;
+    q->count--;
+    pthread_cond_signal(&q->not_full);
+    pthread_mutex_unlock(&q->lock);
+    return batch;
+}
+
+static void queue_mark_done(SweepQueue *q) {
+    pthread_mutex_lock(&q->lock);
+    q->done = 1;
+    pthread_cond_broadcast(&q->not_empty);
+    pthread_mutex_unlock(&q->lock);
+}
+
+//Worker thread body: drain batches into this configuration's private cache
+static void* sweep_worker_main(void *arg) {
+    SweepWorker *worker = (SweepWorker*)arg;
+    Cache *cache = worker->cfg->cache;
+    int prefetch = worker->cfg->prefetch;
+
+    SweepBatch *batch;
+    while ((batch = queue_pop(&worker->queue)) != NULL) {
+        simulate_batch(cache, batch->recs, (size_t)batch->count, prefetch);
+        //Last worker to finish a batch hands it back to the producer
+        pthread_mutex_lock(&batch->lock);
+        if (--batch->pending == 0) {
+            pthread_cond_signal(&batch->drained);
+        }
+        pthread_mutex_unlock(&batch->lock);
+    }
+    return NULL;
+}
+
+int sweep_run_threaded(Sweep *sweep, const char *trace_file) {
+    TraceReader *reader = trace_open(trace_file);
+    if (!reader) {
+        fprintf(stderr, "Error: Cannot open trace file %s\n", trace_file);
+        return 1;
+    }
+
+    //Fixed pool of batch buffers recycled by the producer
+    SweepBatch *pool = (SweepBatch*)malloc(SWEEP_BATCH_POOL * sizeof(SweepBatch));
+    SweepWorker *workers = (SweepWorker*)malloc(sweep->count * sizeof(SweepWorker));
+    if (!pool || !workers) {
+        fprintf(stderr, "Error: malloc failed\n");
+        exit(1);
+    }
+    for (int i = 0; i < SWEEP_BATCH_POOL; i++) {
+        pool[i].count = 0;
+        pool[i].pending = 0;
+        pthread_mutex_init(&pool[i].lock, NULL);
+        pthread_cond_init(&pool[i].drained, NULL);
+    }
+    for (int i = 0; i < sweep->count; i++) {
+        workers[i].cfg = &sweep->configs[i];
+        queue_init(&workers[i].queue);
+        if (pthread_create(&workers[i].thread, NULL, sweep_worker_main, &workers[i]) != 0) {
+            fprintf(stderr, "Error: pthread_create failed\n");
+            exit(1);
+        }
+    }
+
+    //Producer: decode records into pool batches and publish each filled batch
+    //to every worker queue; records 'op' only as R/W so the filter matches the
+    //serial path (unknown ops are dropped before publication)
+    int slot = 0;
+    int eof = 0;
+    while (!eof) {
+        SweepBatch *batch = &pool[slot];
+
+        //Wait until every worker has drained this buffer's previous contents
+        pthread_mutex_lock(&batch->lock);
+        while (batch->pending != 0) {
+            pthread_cond_wait(&batch->drained, &batch->lock);
+        }
+        pthread_mutex_unlock(&batch->lock);
+
+        batch->count = 0;
+        TraceRecord rec;
+        while (batch->count < SWEEP_BATCH_RECORDS) {
+            if (!trace_next(reader, &rec)) {
+                eof = 1;
+                break;
+            }
+            if (rec.op == 'R' || rec.op == 'W') {
+                batch->recs[batch->count++] = rec;
+            }
+        }
+        if (batch->count == 0) {
+            break;
+        }
+
+        batch->pending = sweep->count;
+        for (int i = 0; i < sweep->count; i++) {
+            queue_push(&workers[i].queue, batch);
+        }
+        slot = (slot + 1) % SWEEP_BATCH_POOL;
+    }
+
+    //Signal end of input and wait for all workers to finish
+    for (int i = 0; i < sweep->count; i++) {
+        queue_mark_done(&workers[i].queue);
+    }
+    for (int i = 0; i < sweep->count; i++) {
+        pthread_join(workers[i].thread, NULL);
+        //Append each configuration's row as soon as its worker finishes, so a
+        //farm can tail the results file while long sweeps are still running
+        if (sweep->results_path) {
+            results_append(sweep->results_path, trace_file,
+                           sweep->configs[i].cache, sweep->configs[i].prefetch);
+        }
+    }
+
+    free(workers);
+    free(pool);
+    trace_close(reader);
+    return 0;
+}
+
+void sweep_report(Sweep *sweep) {
+    for (int i = 0; i < sweep->count; i++) {
+        SweepConfig *cfg = &sweep->configs[i];
+        printf("Config %d: size=%d %s %s block=%d\n",
+               i, cfg->cache_size, cfg->assoc_str, cfg->policy_str, cfg->block_size);
+        print_stats(cfg->cache, cfg->prefetch);
+    }
+}
+
+void sweep_free(Sweep *sweep) {
+    for (int i = 0; i < sweep->count; i++) {
+        free_cache(sweep->configs[i].cache);
+    }
+    free(sweep->configs);
+    free(sweep);
+}
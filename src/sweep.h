@@ -0,0 +1,45 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include "cache.h"
+
+//SweepConfig is one cache configuration in a sweep, plus its Cache instance
+typedef struct {
+    int cache_size;
+    int associativity;
+    int block_size;
+    int policy;
+    int prefetch;
+    char assoc_str[32];     //original spec, kept for the report
+    char policy_str[8];
+    Cache *cache;
+} SweepConfig;
+
+//Sweep holds the list of configurations replayed in one trace pass; when
+//results_path is set, each configuration's counters are appended to that
+//shared results file as the configuration finishes
+typedef struct {
+    SweepConfig *configs;
+    int count;
+    const char *results_path;
+} Sweep;
+
+//Parses a sweep configuration file (one "<size> <assoc> <policy> <block> [prefetch]"
+//per line, '#' comments allowed); returns NULL on failure
+Sweep* sweep_load(const char *config_path);
+
+//Replays the trace once, dispatching every record to all configurations;
+//returns 0 on success
+int sweep_run(Sweep *sweep, const char *trace_file);
+
+//Threaded variant of sweep_run: one worker thread per configuration, fed
+//decoded records in large batches; returns 0 on success
+int sweep_run_threaded(Sweep *sweep, const char *trace_file);
+
+//Prints per-configuration stats in file order
+void sweep_report(Sweep *sweep);
+
+//Frees all caches and sweep state
+void sweep_free(Sweep *sweep);
+
+#endif
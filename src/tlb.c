@@ -0,0 +1,105 @@
+//TLB model: a small set-associative LRU cache of page translations, run as a
+//second consumer of each decoded batch. The decoded block_id already carries
+//the address shifted by block_bits, so the page number is one more shift and
+//the model never touches the raw trace.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tlb.h"
+
+//Memory references charged per page walk (4-level radix table)
+#define TLB_WALK_LEVELS 4
+
+Tlb* parse_tlb(const char *spec) {
+    //"ENTRIES[:ASSOC[:PAGE_SIZE]]", e.g. "64", "64:4", "1024:8:2097152"
+    int entries = 0;
+    int ways = 4;
+    int page_size = 4096;
+    if (sscanf(spec, "%d:%d:%d", &entries, &ways, &page_size) < 1) {
+        return NULL;
+    }
+    if (entries <= 0 || ways <= 0 || entries % ways != 0 ||
+        !is_power_of_two((unsigned long)entries) ||
+        !is_power_of_two((unsigned long)(entries / ways)) ||
+        !is_power_of_two((unsigned long)page_size)) {
+        return NULL;
+    }
+
+    Tlb *tlb = (Tlb*)malloc(sizeof(Tlb));
+    if (!tlb) {
+        fprintf(stderr, "Error: malloc failed\n");
+        exit(1);
+    }
+    tlb->entries = entries;
+    tlb->ways = ways;
+    tlb->sets = entries / ways;
+    tlb->set_bits = log2_int((unsigned long)tlb->sets);
+    tlb->page_bits = log2_int((unsigned long)page_size);
+    tlb->tick = 0;
+    tlb->tags = (unsigned long*)calloc((size_t)entries, sizeof(unsigned long));
+    tlb->ages = (unsigned long*)calloc((size_t)entries, sizeof(unsigned long));
+    if (!tlb->tags || !tlb->ages) {
+        fprintf(stderr, "Error: malloc failed\n");
+        exit(1);
+    }
+    tlb->hits = 0;
+    tlb->misses = 0;
+    tlb->walk_refs = 0;
+    return tlb;
+}
+
+void tlb_access_batch(Tlb *tlb, const DecodedRecord *recs, size_t n,
+                      int block_bits) {
+    int page_shift = tlb->page_bits - block_bits;
+    unsigned long set_mask = (unsigned long)tlb->sets - 1;
+    int ways = tlb->ways;
+
+    for (size_t r = 0; r < n; r++) {
+        unsigned long page = recs[r].block_id >> page_shift;
+        unsigned long set = page & set_mask;
+        unsigned long tag = page >> tlb->set_bits;
+        unsigned long *tags = tlb->tags + set * (unsigned long)ways;
+        unsigned long *ages = tlb->ages + set * (unsigned long)ways;
+
+        int hit = -1;
+        for (int i = 0; i < ways; i++) {
+            if (ages[i] != 0 && tags[i] == tag) {
+                hit = i;
+                break;
+            }
+        }
+        if (hit >= 0) {
+            tlb->hits++;
+            ages[hit] = ++tlb->tick;
+            continue;
+        }
+
+        //Miss: walk the page table, then install over the LRU entry
+        //(age 0 marks an invalid entry and always loses)
+        tlb->misses++;
+        tlb->walk_refs += TLB_WALK_LEVELS;
+        int victim = 0;
+        for (int i = 1; i < ways; i++) {
+            if (ages[i] < ages[victim]) {
+                victim = i;
+            }
+        }
+        tags[victim] = tag;
+        ages[victim] = ++tlb->tick;
+    }
+}
+
+void tlb_report(const Tlb *tlb) {
+    printf("TLB (%d entries, %d-way, %lu-byte pages)\n",
+           tlb->entries, tlb->ways, 1UL << tlb->page_bits);
+    printf("TLB hits: %lu\n", tlb->hits);
+    printf("TLB misses: %lu\n", tlb->misses);
+    printf("Page walk memory references: %lu\n", tlb->walk_refs);
+}
+
+void free_tlb(Tlb *tlb) {
+    free(tlb->tags);
+    free(tlb->ages);
+    free(tlb);
+}
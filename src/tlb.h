@@ -0,0 +1,44 @@
+#ifndef TLB_H
+#define TLB_H
+
+#include <stddef.h>
+
+#include "cache.h"
+
+//Optional TLB model, fed from the same decoded record stream as the cache so
+//TLB+cache co-simulation costs one extra pass over each decoded batch instead
+//of a second tool run over the raw trace. Set-associative, LRU replacement;
+//each miss charges a fixed number of page-walk memory references.
+
+//Tlb stores its geometry and entry arenas in the same structure-of-arrays
+//shape as Cache: tags and ages indexed set * ways + i, zero age = invalid
+typedef struct {
+    int entries;
+    int ways;
+    int sets;
+    int set_bits;
+    int page_bits;
+    unsigned long tick;
+    unsigned long *tags;    //sets * ways page tags
+    unsigned long *ages;    //sets * ways LRU timestamps; 0 = invalid
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long walk_refs;
+} Tlb;
+
+//Parses a TLB spec "ENTRIES[:ASSOC[:PAGE_SIZE]]" (defaults: 4-way, 4096-byte
+//pages) and allocates the model; returns NULL on a malformed spec
+Tlb* parse_tlb(const char *spec);
+
+//Looks up every record's page in one call; block_bits converts the decoded
+//block_id back to a page number, so page_size must be >= the cache block size
+void tlb_access_batch(Tlb *tlb, const DecodedRecord *recs, size_t n,
+                      int block_bits);
+
+//Prints TLB hits/misses and page-walk memory references
+void tlb_report(const Tlb *tlb);
+
+//Frees the TLB arenas
+void free_tlb(Tlb *tlb);
+
+#endif
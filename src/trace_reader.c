@@ -0,0 +1,416 @@
+//Memory-mapped trace reader: maps the whole trace file and decodes records with a
+//hand-rolled hex scanner instead of fgets/sscanf, so ingest runs at memory speed.
+//Produces the same record stream as the old stdio loop (malformed lines skipped,
+//"#eof" terminates) so simulation results stay bit-identical.
+//
+//Compressed traces (gzip/zstd/xz, detected by magic bytes) are ingested
+//transparently: the reader pipes the file through the matching decompressor
+//subprocess and scans a sliding window over the pipe, so decompression runs
+//concurrently with simulation and no intermediate file is ever written.
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "trace_reader.h"
+
+//Packed binary trace format: 8-byte magic, then fixed-size 17-byte records
+//(op byte, 64-bit pc, 64-bit address, host byte order). Replay needs no
+//per-record parsing: records are memcpy'd straight out of the mapping.
+#define TRACE_BIN_MAGIC     "CSIMTRC1"
+#define TRACE_BIN_MAGIC_LEN 8
+#define TRACE_BIN_REC_SIZE  17
+
+//Sliding-window size for compressed (piped) input
+#define TRACE_STREAM_BUF (1 << 20)
+
+struct TraceReader {
+    const char *base;   //start of the mapped file (or the stream window)
+    const char *cur;    //current scan position
+    const char *end;    //one past the last valid byte
+    size_t map_len;
+    int binary;         //1 if the input holds packed binary records
+    FILE *stream;       //decompressor pipe for compressed input, else NULL
+    pid_t stream_pid;   //decompressor subprocess, reaped in trace_close()
+    char *stream_buf;   //sliding window the pipe refills
+    int stream_eof;     //1 once the pipe has been drained
+    unsigned long stream_consumed;  //decompressed bytes retired before base
+};
+
+//Returns the decompressor for the file's magic bytes, or NULL if uncompressed
+static const char* compression_tool(const unsigned char *magic, size_t len) {
+    if (len >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+        return "gzip";
+    }
+    if (len >= 4 && magic[0] == 0x28 && magic[1] == 0xb5 &&
+        magic[2] == 0x2f && magic[3] == 0xfd) {
+        return "zstd";
+    }
+    if (len >= 6 && memcmp(magic, "\xfd""7zXZ\x00", 6) == 0) {
+        return "xz";
+    }
+    return NULL;
+}
+
+//Refills the stream window: keeps the unconsumed tail, tops up from the pipe
+static void stream_refill(TraceReader *reader) {
+    size_t tail = (size_t)(reader->end - reader->cur);
+    reader->stream_consumed += (unsigned long)(reader->cur - reader->base);
+    memmove(reader->stream_buf, reader->cur, tail);
+    size_t got = fread(reader->stream_buf + tail, 1,
+                       TRACE_STREAM_BUF - tail, reader->stream);
+    if (got == 0) {
+        reader->stream_eof = 1;
+    }
+    reader->base = reader->cur = reader->stream_buf;
+    reader->end = reader->stream_buf + tail + got;
+}
+
+//Opens a compressed trace by piping it through its decompressor; the subprocess
+//runs concurrently with simulation, so ingest overlaps decompression. The tool
+//is exec'd directly with the path as an argv element — no shell ever sees the
+//filename, so quoting and metacharacters in it are not an issue.
+static TraceReader* trace_open_compressed(const char *path, const char *tool) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return NULL;
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return NULL;
+    }
+    if (pid == 0) {
+        //Child: decompress to the pipe's write end
+        char *argv[4];
+        argv[0] = (char*)tool;
+        argv[1] = (char*)"-dc";
+        argv[2] = (char*)path;
+        argv[3] = NULL;
+        close(fds[0]);
+        if (dup2(fds[1], STDOUT_FILENO) < 0) {
+            _exit(127);
+        }
+        close(fds[1]);
+        execvp(tool, argv);
+        fprintf(stderr, "Error: Cannot run %s\n", tool);
+        _exit(127);
+    }
+    close(fds[1]);
+    FILE *stream = fdopen(fds[0], "r");
+    if (!stream) {
+        close(fds[0]);
+        waitpid(pid, NULL, 0);
+        return NULL;
+    }
+
+    TraceReader *reader = (TraceReader*)malloc(sizeof(TraceReader));
+    char *buf = (char*)malloc(TRACE_STREAM_BUF);
+    if (!reader || !buf) {
+        fprintf(stderr, "Error: malloc failed\n");
+        exit(1);
+    }
+    reader->map_len = 0;
+    reader->stream = stream;
+    reader->stream_pid = pid;
+    reader->stream_buf = buf;
+    reader->stream_eof = 0;
+    reader->stream_consumed = 0;
+    reader->base = reader->cur = reader->end = buf;
+    stream_refill(reader);
+
+    //The decompressed head may itself be a packed binary trace
+    reader->binary = 0;
+    if (reader->end - reader->cur >= TRACE_BIN_MAGIC_LEN &&
+        memcmp(reader->cur, TRACE_BIN_MAGIC, TRACE_BIN_MAGIC_LEN) == 0) {
+        reader->binary = 1;
+        reader->cur += TRACE_BIN_MAGIC_LEN;
+    }
+    return reader;
+}
+
+TraceReader* trace_open(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return NULL;
+    }
+
+    //Compressed input: hand the file to a decompressor pipe instead of mmap
+    unsigned char magic[6];
+    ssize_t got = pread(fd, magic, sizeof(magic), 0);
+    if (got > 0) {
+        const char *tool = compression_tool(magic, (size_t)got);
+        if (tool) {
+            close(fd);
+            return trace_open_compressed(path, tool);
+        }
+    }
+
+    TraceReader *reader = (TraceReader*)malloc(sizeof(TraceReader));
+    if (!reader) {
+        fprintf(stderr, "Error: malloc failed\n");
+        exit(1);
+    }
+    reader->stream = NULL;
+    reader->stream_buf = NULL;
+    reader->stream_eof = 0;
+    reader->stream_consumed = 0;
+
+    //Empty trace: nothing to map, reader immediately reports end-of-trace
+    if (st.st_size == 0) {
+        close(fd);
+        reader->base = reader->cur = reader->end = NULL;
+        reader->map_len = 0;
+        return reader;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        free(reader);
+        return NULL;
+    }
+
+    //Hint the kernel that we scan front-to-back exactly once
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    reader->base = (const char*)map;
+    reader->cur = reader->base;
+    reader->end = reader->base + st.st_size;
+    reader->map_len = (size_t)st.st_size;
+
+    //Detect the packed binary format by its magic and skip the header
+    reader->binary = 0;
+    if (reader->map_len >= TRACE_BIN_MAGIC_LEN &&
+        memcmp(reader->base, TRACE_BIN_MAGIC, TRACE_BIN_MAGIC_LEN) == 0) {
+        reader->binary = 1;
+        reader->cur += TRACE_BIN_MAGIC_LEN;
+    }
+    return reader;
+}
+
+//Maps an ASCII byte to its hex value, or -1 if not a hex digit
+static int hex_val(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+//Parses a hex number (with optional 0x prefix) at *p; returns 1 on success and
+//advances *p past the digits
+static int scan_hex(const char **p, const char *end, unsigned long *out) {
+    const char *s = *p;
+    if (s + 1 < end && s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
+        s += 2;
+    }
+
+    unsigned long value = 0;
+    int digits = 0;
+    while (s < end) {
+        int v = hex_val(*s);
+        if (v < 0) break;
+        value = (value << 4) | (unsigned long)v;
+        s++;
+        digits++;
+    }
+
+    if (digits == 0) {
+        return 0;
+    }
+    *p = s;
+    *out = value;
+    return 1;
+}
+
+//Advances *p past spaces and tabs (not newlines)
+static void skip_blanks(const char **p, const char *end) {
+    while (*p < end && (**p == ' ' || **p == '\t')) {
+        (*p)++;
+    }
+}
+
+//Advances *p to just past the next newline (or to end of mapping)
+static void skip_line(const char **p, const char *end) {
+    const char *nl = memchr(*p, '\n', (size_t)(end - *p));
+    *p = nl ? nl + 1 : end;
+}
+
+//Decodes the next packed binary record; no parsing, just two copies
+static int trace_next_binary(TraceReader *reader, TraceRecord *rec) {
+    if (reader->stream && !reader->stream_eof &&
+        reader->end - reader->cur < TRACE_BIN_REC_SIZE) {
+        stream_refill(reader);
+    }
+    if (reader->end - reader->cur < TRACE_BIN_REC_SIZE) {
+        return 0;
+    }
+    rec->op = (reader->cur[0] == 0) ? 'R' : 'W';
+    memcpy(&rec->pc, reader->cur + 1, sizeof(unsigned long));
+    memcpy(&rec->address, reader->cur + 9, sizeof(unsigned long));
+    reader->cur += TRACE_BIN_REC_SIZE;
+    return 1;
+}
+
+int trace_next(TraceReader *reader, TraceRecord *rec) {
+    if (reader->binary) {
+        return trace_next_binary(reader, rec);
+    }
+
+    while (reader->cur < reader->end || (reader->stream && !reader->stream_eof)) {
+        //Streamed input: make sure the window holds a complete line (or the
+        //final partial one) before the scanner looks at it
+        if (reader->stream && !reader->stream_eof &&
+            (reader->cur >= reader->end ||
+             memchr(reader->cur, '\n', (size_t)(reader->end - reader->cur)) == NULL)) {
+            stream_refill(reader);
+            continue;
+        }
+        const char *end = reader->end;
+        if (reader->cur >= end) {
+            break;
+        }
+        const char *p = reader->cur;
+        skip_blanks(&p, end);
+
+        //Skip blank lines
+        if (p < end && (*p == '\n' || *p == '\r')) {
+            skip_line(&reader->cur, end);
+            continue;
+        }
+
+        //"#eof" marks the end of the trace
+        if (end - p >= 4 && strncmp(p, "#eof", 4) == 0) {
+            reader->cur = end;
+            reader->stream_eof = 1;
+            return 0;
+        }
+
+        //Expected line format: "<pc>: <R/W> <address>"
+        unsigned long pc, address;
+        char op;
+        if (scan_hex(&p, end, &pc) &&
+            p < end && *p == ':' && (p++, skip_blanks(&p, end), 1) &&
+            p < end && ((op = *p) == 'R' || op == 'W') &&
+            (p++, skip_blanks(&p, end), 1) &&
+            scan_hex(&p, end, &address)) {
+            skip_line(&reader->cur, end);
+            rec->pc = pc;
+            rec->address = address;
+            rec->op = op;
+            return 1;
+        }
+
+        //Malformed line: skip it, same as the old sscanf!=3 behavior
+        skip_line(&reader->cur, end);
+    }
+
+    return 0;
+}
+
+unsigned long trace_tell(const TraceReader *reader) {
+    if (reader->stream) {
+        return reader->stream_consumed + (unsigned long)(reader->cur - reader->base);
+    }
+    return (unsigned long)(reader->cur - reader->base);
+}
+
+int trace_seek(TraceReader *reader, unsigned long offset) {
+    if (!reader->stream) {
+        if (offset > reader->map_len) {
+            return -1;
+        }
+        reader->cur = reader->base + offset;
+        return 0;
+    }
+    //Piped input is forward-only: skip decompressed bytes until the offset
+    if (offset < trace_tell(reader)) {
+        return -1;
+    }
+    while (trace_tell(reader) < offset) {
+        size_t avail = (size_t)(reader->end - reader->cur);
+        if (avail == 0) {
+            if (reader->stream_eof) {
+                return -1;
+            }
+            stream_refill(reader);
+            continue;
+        }
+        unsigned long want = offset - trace_tell(reader);
+        reader->cur += (want < avail) ? want : avail;
+    }
+    return 0;
+}
+
+size_t trace_next_batch(TraceReader *reader, TraceRecord *recs, size_t max) {
+    size_t n = 0;
+    while (n < max && trace_next(reader, &recs[n])) {
+        n++;
+    }
+    return n;
+}
+
+int trace_convert(const char *text_path, const char *bin_path) {
+    TraceReader *reader = trace_open(text_path);
+    if (!reader) {
+        fprintf(stderr, "Error: Cannot open trace file %s\n", text_path);
+        return 1;
+    }
+
+    FILE *out = fopen(bin_path, "wb");
+    if (!out) {
+        fprintf(stderr, "Error: Cannot create output file %s\n", bin_path);
+        trace_close(reader);
+        return 1;
+    }
+
+    if (fwrite(TRACE_BIN_MAGIC, 1, TRACE_BIN_MAGIC_LEN, out) != TRACE_BIN_MAGIC_LEN) {
+        fprintf(stderr, "Error: Write failed on %s\n", bin_path);
+        fclose(out);
+        trace_close(reader);
+        return 1;
+    }
+
+    //Re-encode every decoded record as one fixed-size binary record
+    TraceRecord rec;
+    unsigned char buf[TRACE_BIN_REC_SIZE];
+    while (trace_next(reader, &rec)) {
+        buf[0] = (rec.op == 'R') ? 0 : 1;
+        memcpy(buf + 1, &rec.pc, sizeof(unsigned long));
+        memcpy(buf + 9, &rec.address, sizeof(unsigned long));
+        if (fwrite(buf, 1, TRACE_BIN_REC_SIZE, out) != TRACE_BIN_REC_SIZE) {
+            fprintf(stderr, "Error: Write failed on %s\n", bin_path);
+            fclose(out);
+            trace_close(reader);
+            return 1;
+        }
+    }
+
+    fclose(out);
+    trace_close(reader);
+    return 0;
+}
+
+void trace_close(TraceReader *reader) {
+    if (reader->stream) {
+        fclose(reader->stream);
+        waitpid(reader->stream_pid, NULL, 0);
+        free(reader->stream_buf);
+    } else if (reader->base) {
+        munmap((void*)reader->base, reader->map_len);
+    }
+    free(reader);
+}
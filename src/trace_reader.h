@@ -0,0 +1,39 @@
+#ifndef TRACE_READER_H
+#define TRACE_READER_H
+
+#include <stddef.h>
+
+//TraceRecord is one decoded trace entry: program counter, access type, and address
+typedef struct {
+    unsigned long pc;
+    unsigned long address;
+    char op;    //'R' or 'W'
+} TraceRecord;
+
+//Opaque reader handle; owns the mapping/file state
+typedef struct TraceReader TraceReader;
+
+//Opens a trace file and prepares it for sequential decoding; returns NULL on failure
+TraceReader* trace_open(const char *path);
+
+//Decodes the next record into *rec; returns 1 on success, 0 at end of trace
+int trace_next(TraceReader *reader, TraceRecord *rec);
+
+//Decodes up to max records into recs; returns the number decoded (0 at end of
+//trace). Lets the simulation loop work on thousands of records per call.
+size_t trace_next_batch(TraceReader *reader, TraceRecord *recs, size_t max);
+
+//Returns the current position as a byte offset into the (decompressed) input
+unsigned long trace_tell(const TraceReader *reader);
+
+//Repositions the reader at a trace_tell() offset; piped (compressed) input
+//seeks forward only. Returns 0 on success, -1 on failure.
+int trace_seek(TraceReader *reader, unsigned long offset);
+
+//Releases the mapping and all reader state
+void trace_close(TraceReader *reader);
+
+//Converts a text trace to the packed binary format; returns 0 on success
+int trace_convert(const char *text_path, const char *bin_path);
+
+#endif